@@ -0,0 +1,254 @@
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "FiniteAutomaton.h"
+#include "PostfixConverter.h"
+#include "RegToken.h"
+
+using json = nlohmann::json;
+
+// Times every stage of the pipeline on synthetic pattern families and random corpora,
+// and prints the results as JSON (stdout, or --output <file>).
+namespace {
+    struct BenchmarkConfig {
+        size_t corpusBytes = size_t{4} << 20;
+        int repeat = 5;
+        uint32_t seed = 42;
+        std::string output;
+    };
+
+    struct PatternCase {
+        std::string family;
+        int size;
+        std::string regex;
+        std::string alphabet;
+    };
+
+    // Keeps the optimizer from dropping the measured calls.
+    volatile size_t sink = 0;
+
+    double medianMillis(const int repeat, const std::function<void()> &action) {
+        std::vector<double> samples;
+        for (int i = 0; i < repeat; ++i) {
+            const auto start = std::chrono::steady_clock::now();
+            action();
+            const auto end = std::chrono::steady_clock::now();
+            samples.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+        }
+        std::sort(samples.begin(), samples.end());
+        return samples[samples.size() / 2];
+    }
+
+    double megabytesPerSecond(const size_t bytes, const double millis) {
+        return millis > 0 ? static_cast<double>(bytes) / (millis * 1000.0) : 0.0;
+    }
+
+    std::vector<PatternCase> patternFamilies(std::mt19937 &rng) {
+        std::vector<PatternCase> cases;
+
+        // ((((a)*b)*a)*b)*: stars nested n deep.
+        for (const int depth: {2, 4, 8}) {
+            std::string regex = "a";
+            for (int level = 1; level <= depth; ++level) {
+                regex = "(" + regex + ")*" + (level % 2 ? "b" : "a");
+            }
+            cases.push_back({"nested-stars", depth, regex, "ab"});
+        }
+
+        // (w1|w2|...|wn) over random words of length 6.
+        for (const int width: {8, 64, 256}) {
+            std::uniform_int_distribution<int> letter(0, 3);
+            std::string regex = "(";
+            for (int word = 0; word < width; ++word) {
+                if (word) regex += '|';
+                for (int i = 0; i < 6; ++i) regex += static_cast<char>('a' + letter(rng));
+            }
+            regex += ")";
+            cases.push_back({"wide-alternation", width, regex, "abcd"});
+        }
+
+        // (a|b)*a(a|b){n}: the classic exponential subset construction.
+        for (const int n: {4, 8, 12}) {
+            std::string regex = "(a|b)*a";
+            for (int i = 0; i < n; ++i) regex += "(a|b)";
+            cases.push_back({"nth-from-last", n, regex, "ab"});
+        }
+
+        return cases;
+    }
+
+    std::string randomCorpus(const size_t bytes, const std::string &alphabet, std::mt19937 &rng) {
+        std::uniform_int_distribution<size_t> pick(0, alphabet.size() - 1);
+        std::string corpus(bytes, '\0');
+        for (auto &c: corpus) c = alphabet[pick(rng)];
+        return corpus;
+    }
+
+    // The corpus cut into consecutive words of 8 to 64 bytes, for the batch API.
+    std::vector<std::string_view> splitWords(const std::string &corpus, std::mt19937 &rng) {
+        std::uniform_int_distribution<size_t> length(8, 64);
+        std::vector<std::string_view> words;
+        for (size_t begin = 0; begin < corpus.size();) {
+            const size_t size = std::min(length(rng), corpus.size() - begin);
+            words.emplace_back(corpus.data() + begin, size);
+            begin += size;
+        }
+        return words;
+    }
+
+    json benchmarkEngine(const std::string &name, const std::string &postfix, const std::string &corpus,
+                         const std::vector<std::string_view> &words, const BenchmarkConfig &config,
+                         const CompileOptions &options) {
+        json result;
+        result["engine"] = name;
+        result["compileMs"] = medianMillis(config.repeat, [&] {
+            delete FiniteAutomaton::buildFromRegex(postfix, options);
+        });
+
+        const std::unique_ptr<const FiniteAutomaton> fa(FiniteAutomaton::buildFromRegex(postfix, options));
+        const double processMs = medianMillis(config.repeat, [&] { sink = sink + fa->process(corpus); });
+        size_t matches = 0;
+        const double searchMs = medianMillis(config.repeat, [&] { matches = fa->search(corpus).size(); });
+        const double wordLoopMs = medianMillis(config.repeat, [&] {
+            for (const auto word: words) sink = sink + fa->process(std::string(word));
+        });
+        const double batchMs = medianMillis(config.repeat, [&] { sink = sink + fa->processMany(words).size(); });
+
+        result["processMBps"] = megabytesPerSecond(corpus.size(), processMs);
+        result["searchMBps"] = megabytesPerSecond(corpus.size(), searchMs);
+        result["searchMatches"] = matches;
+        result["wordLoopMBps"] = megabytesPerSecond(corpus.size(), wordLoopMs);
+        result["batchMBps"] = megabytesPerSecond(corpus.size(), batchMs);
+        result["memoryBytes"] = fa->getMemoryFootprint();
+        return result;
+    }
+
+    json benchmarkPattern(const PatternCase &pattern, const BenchmarkConfig &config, std::mt19937 &rng) {
+        json result;
+        result["family"] = pattern.family;
+        result["size"] = pattern.size;
+        result["regex"] = pattern.regex;
+
+        std::string postfix;
+        json stages;
+        stages["postfixMs"] = medianMillis(config.repeat, [&] {
+            postfix = PostfixConverter::getPostfix(pattern.regex);
+        });
+
+        NFAGraph graph;
+        RegToken token(-1, -1);
+        stages["thompsonMs"] = medianMillis(config.repeat, [&] {
+            graph = NFAGraph();
+            token = RegToken::getENFAToken(postfix, graph);
+        });
+        result["nfaNodes"] = graph.size();
+        result["nfaEdges"] = graph.edgeCount();
+
+        stages["lambdaScopeMs"] = medianMillis(config.repeat, [&] {
+            sink = sink + FiniteAutomaton::LambdaScope(graph).size();
+        });
+
+        std::vector<char> sigma_vec(pattern.alphabet.begin(), pattern.alphabet.end());
+        std::sort(sigma_vec.begin(), sigma_vec.end());
+        size_t dfaStates = 0;
+        stages["determinizeMs"] = medianMillis(config.repeat, [&] {
+            dfaStates = FiniteAutomaton::determinize(graph, token.startNode, sigma_vec).transitions.size();
+        });
+        result["dfaStates"] = dfaStates;
+        result["stages"] = stages;
+
+        const std::string corpus = randomCorpus(config.corpusBytes, pattern.alphabet, rng);
+        const std::vector<std::string_view> words = splitWords(corpus, rng);
+
+        CompileOptions options;
+
+        json engines = json::array();
+        for (const auto &[name, engine]: {
+                 std::pair{"Auto", MatchEngine::Auto}, std::pair{"DFA", MatchEngine::DFA},
+                 std::pair{"LazyDFA", MatchEngine::LazyDFA}, std::pair{"BitParallel", MatchEngine::BitParallel},
+                 std::pair{"Literal", MatchEngine::Literal}
+             }) {
+            if (engine == MatchEngine::BitParallel && !GlushkovMatcher::build(postfix)) {
+                continue;
+            }
+            if (engine == MatchEngine::Literal && LiteralExtractor::extract(postfix).language.empty()) {
+                continue;
+            }
+            options.engine = engine;
+            engines.push_back(benchmarkEngine(name, postfix, corpus, words, config, options));
+        }
+        result["engines"] = engines;
+
+        return result;
+    }
+
+    bool parseArguments(const int argc, char **argv, BenchmarkConfig &config) {
+        for (int i = 1; i < argc; ++i) {
+            const std::string flag = argv[i];
+            if (i + 1 >= argc) return false;
+            const std::string value = argv[++i];
+
+            if (flag == "--corpus-bytes") config.corpusBytes = std::stoull(value);
+            else if (flag == "--repeat") config.repeat = std::max(1, std::stoi(value));
+            else if (flag == "--seed") config.seed = static_cast<uint32_t>(std::stoul(value));
+            else if (flag == "--output") config.output = value;
+            else return false;
+        }
+        return config.corpusBytes > 0;
+    }
+}
+
+int main(const int argc, char **argv) {
+    BenchmarkConfig config;
+    if (!parseArguments(argc, argv, config)) {
+        std::cerr << "Usage: " << argv[0]
+                << " [--corpus-bytes N] [--repeat N] [--seed N] [--output results.json]" << std::endl;
+        return 1;
+    }
+
+    std::mt19937 rng(config.seed);
+
+    json report;
+    report["corpusBytes"] = config.corpusBytes;
+    report["repeat"] = config.repeat;
+    report["seed"] = config.seed;
+
+    json patterns = json::array();
+    bool enginesAgree = true;
+    for (const auto &pattern: patternFamilies(rng)) {
+        std::cerr << "Benchmarking " << pattern.family << " / " << pattern.size << std::endl;
+        patterns.push_back(benchmarkPattern(pattern, config, rng));
+
+        // Every engine searched the same corpus, so they must find the same matches.
+        for (const auto &engine: patterns.back()["engines"]) {
+            if (engine["searchMatches"] != patterns.back()["engines"][0]["searchMatches"]) {
+                std::cerr << "Error: " << engine["engine"].get<std::string>() << " disagrees on "
+                        << pattern.family << " / " << pattern.size << std::endl;
+                enginesAgree = false;
+            }
+        }
+    }
+    report["patterns"] = patterns;
+
+    if (config.output.empty()) {
+        std::cout << report.dump(2) << std::endl;
+    } else {
+        std::ofstream out(config.output);
+        if (!out.is_open()) {
+            std::cerr << "Error: Could not open file " << config.output << std::endl;
+            return 1;
+        }
+        out << report.dump(2) << std::endl;
+    }
+
+    return enginesAgree ? 0 : 1;
+}
@@ -0,0 +1,28 @@
+# regexlfa_add_matchers(<target> NAME <file stem> [NAMESPACE <ns>] PATTERNS <name>=<regex>...)
+#
+# Generates <file stem>.cpp / <file stem>.h in the current binary directory with one
+# direct-coded DFA function `bool <name>(std::string_view)` per pattern, and adds them
+# to <target>. The files are regenerated whenever the patterns or the generator change.
+function(regexlfa_add_matchers target)
+    cmake_parse_arguments(ARG "" "NAME;NAMESPACE" "PATTERNS" ${ARGN})
+    if (NOT ARG_NAME OR NOT ARG_PATTERNS)
+        message(FATAL_ERROR "regexlfa_add_matchers: NAME and PATTERNS are required")
+    endif ()
+
+    set(source ${CMAKE_CURRENT_BINARY_DIR}/${ARG_NAME}.cpp)
+    set(header ${CMAKE_CURRENT_BINARY_DIR}/${ARG_NAME}.h)
+    set(namespace_args)
+    if (ARG_NAMESPACE)
+        set(namespace_args --namespace ${ARG_NAMESPACE})
+    endif ()
+
+    add_custom_command(
+            OUTPUT ${source} ${header}
+            COMMAND REGExLFACodegen --output ${source} --header ${header} ${namespace_args} ${ARG_PATTERNS}
+            DEPENDS REGExLFACodegen
+            COMMENT "Generating direct-coded matchers ${ARG_NAME}"
+            VERBATIM)
+
+    target_sources(${target} PRIVATE ${source} ${header})
+    target_include_directories(${target} PRIVATE ${CMAKE_CURRENT_BINARY_DIR})
+endfunction()
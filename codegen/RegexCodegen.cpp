@@ -0,0 +1,236 @@
+#include <cctype>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "FiniteAutomaton.h"
+#include "PostfixConverter.h"
+
+// Turns regexes into a standalone C++ source with one direct-coded DFA function per
+// pattern: every state is a label, reached through a switch on the input byte or, where
+// the compiler supports it, a computed goto through the state's byte-class table.
+//
+//     REGExLFACodegen --output Matchers.cpp [--header Matchers.h] [--namespace ns] name=regex...
+namespace {
+    struct Pattern {
+        std::string name;
+        std::string regex;
+    };
+
+    struct CodegenConfig {
+        std::string output;
+        std::string header;
+        std::string nameSpace;
+        std::vector<Pattern> patterns;
+    };
+
+    bool isIdentifier(const std::string &name) {
+        if (name.empty() || std::isdigit(static_cast<unsigned char>(name[0]))) return false;
+        for (const char c: name) {
+            if (!std::isalnum(static_cast<unsigned char>(c)) && c != '_') return false;
+        }
+        return true;
+    }
+
+    std::string escapeComment(const std::string &text) {
+        std::string result;
+        for (const char c: text) {
+            const auto byte = static_cast<unsigned char>(c);
+            // A backslash could splice the next line into the // comment, so it is spelled out too.
+            if (byte < 0x20 || byte >= 0x7f || c == '\\') {
+                result += std::format("\\x{:02x}", static_cast<int>(byte));
+            } else {
+                result += c;
+            }
+        }
+        return result;
+    }
+
+    std::string declaration(const Pattern &pattern) {
+        return std::format("bool {}(std::string_view text)", pattern.name);
+    }
+
+    void emitMatcher(std::ostream &os, const Pattern &pattern, const CompiledDFA &dfa) {
+        const uint32_t dead = dfa.getDeadState();
+        const uint32_t stateCount = dfa.getStateCount();
+
+        // One representative byte per class, to read each state's row.
+        std::vector<int> representative(dfa.getClassCount(), -1);
+        for (int byte = 0; byte < 256; ++byte) {
+            if (representative[dfa.classOf(static_cast<unsigned char>(byte))] == -1) {
+                representative[dfa.classOf(static_cast<unsigned char>(byte))] = byte;
+            }
+        }
+
+        auto label = [&](const uint32_t state) {
+            return state == dead ? std::string("reject") : std::format("s{}", state);
+        };
+        auto atEnd = [&](const uint32_t state) {
+            return std::format("    if (p == end) return {};\n", dfa.isAccepting(state) ? "true" : "false");
+        };
+
+        os << std::format("// {}\n", escapeComment(pattern.regex));
+        os << declaration(pattern) << " {\n";
+        os << "    const unsigned char *p = reinterpret_cast<const unsigned char *>(text.data());\n";
+        os << "    const unsigned char *const end = p + text.size();\n\n";
+
+        if (dfa.getStartState() == dead) {
+            os << "    return false;\n}\n\n";
+            return;
+        }
+
+        os << "#if REGEXLFA_COMPUTED_GOTO\n";
+        os << "    static constexpr unsigned char classes[256] = {";
+        for (int byte = 0; byte < 256; ++byte) {
+            os << (byte % 16 == 0 ? "\n        " : " ") << static_cast<int>(dfa.classOf(static_cast<unsigned char>(byte)))
+               << ",";
+        }
+        os << "\n    };\n";
+        for (uint32_t state = 0; state < stateCount; ++state) {
+            if (state == dead) continue;
+            os << std::format("    static void *const {}_next[] = {{", label(state));
+            for (uint32_t cls = 0; cls < dfa.getClassCount(); ++cls) {
+                os << (cls ? ", " : "") << "&&"
+                   << label(dfa.next(state, static_cast<unsigned char>(representative[cls])));
+            }
+            os << "};\n";
+        }
+        os << std::format("    goto {};\n\n", label(dfa.getStartState()));
+        for (uint32_t state = 0; state < stateCount; ++state) {
+            if (state == dead) continue;
+            os << label(state) << ":\n" << atEnd(state);
+            os << std::format("    goto *{}_next[classes[*p++]];\n", label(state));
+        }
+        os << "reject:\n    return false;\n";
+
+        os << "#else\n";
+        os << std::format("    goto {};\n\n", label(dfa.getStartState()));
+        for (uint32_t state = 0; state < stateCount; ++state) {
+            if (state == dead) continue;
+
+            std::map<uint32_t, std::vector<int> > bytesByTarget;
+            for (int byte = 0; byte < 256; ++byte) {
+                if (const uint32_t target = dfa.next(state, static_cast<unsigned char>(byte)); target != dead) {
+                    bytesByTarget[target].push_back(byte);
+                }
+            }
+
+            os << label(state) << ":\n" << atEnd(state);
+            os << "    switch (*p++) {\n";
+            for (const auto &[target, bytes]: bytesByTarget) {
+                os << "        ";
+                for (const int byte: bytes) os << std::format("case 0x{:02x}: ", byte);
+                os << std::format("goto {};\n", label(target));
+            }
+            os << "        default: return false;\n    }\n";
+        }
+        os << "#endif\n}\n\n";
+    }
+
+    void emitHeader(std::ostream &os, const CodegenConfig &config) {
+        os << "// Generated by REGExLFACodegen. Do not edit.\n#pragma once\n\n#include <string_view>\n\n";
+        if (!config.nameSpace.empty()) os << "namespace " << config.nameSpace << " {\n";
+        for (const auto &pattern: config.patterns) {
+            os << std::format("// {}\n{};\n", escapeComment(pattern.regex), declaration(pattern));
+        }
+        if (!config.nameSpace.empty()) os << "}\n";
+    }
+
+    void emitSource(std::ostream &os, const CodegenConfig &config,
+                    const std::vector<std::shared_ptr<const CompiledDFA> > &automata) {
+        os << "// Generated by REGExLFACodegen. Do not edit.\n";
+        if (!config.header.empty()) {
+            const size_t slash = config.header.find_last_of("/\\");
+            os << std::format("#include \"{}\"\n", slash == std::string::npos
+                                                       ? config.header
+                                                       : config.header.substr(slash + 1));
+        }
+        os << "#include <string_view>\n\n";
+        os << "#ifndef REGEXLFA_COMPUTED_GOTO\n";
+        os << "#if defined(__GNUC__) || defined(__clang__)\n#define REGEXLFA_COMPUTED_GOTO 1\n";
+        os << "#else\n#define REGEXLFA_COMPUTED_GOTO 0\n#endif\n#endif\n\n";
+
+        if (!config.nameSpace.empty()) os << "namespace " << config.nameSpace << " {\n\n";
+        for (size_t i = 0; i < config.patterns.size(); ++i) {
+            emitMatcher(os, config.patterns[i], *automata[i]);
+        }
+        if (!config.nameSpace.empty()) os << "}\n";
+    }
+
+    bool parseArguments(const int argc, char **argv, CodegenConfig &config) {
+        for (int i = 1; i < argc; ++i) {
+            const std::string argument = argv[i];
+            if (argument == "--output" || argument == "--header" || argument == "--namespace") {
+                if (i + 1 >= argc) return false;
+                std::string &target = argument == "--output"
+                                          ? config.output
+                                          : argument == "--header" ? config.header : config.nameSpace;
+                target = argv[++i];
+                continue;
+            }
+
+            const size_t equals = argument.find('=');
+            if (equals == std::string::npos || !isIdentifier(argument.substr(0, equals))
+                || equals + 1 == argument.size()) {
+                std::cerr << "Error: Expected name=regex, got " << argument << std::endl;
+                return false;
+            }
+            config.patterns.push_back({argument.substr(0, equals), argument.substr(equals + 1)});
+        }
+        return !config.output.empty() && !config.patterns.empty();
+    }
+
+    bool writeFile(const std::string &path, const std::string &content) {
+        std::ofstream out(path);
+        if (!out.is_open()) {
+            std::cerr << "Error: Could not open file " << path << std::endl;
+            return false;
+        }
+        out << content;
+        return static_cast<bool>(out);
+    }
+}
+
+int main(const int argc, char **argv) {
+    CodegenConfig config;
+    if (!parseArguments(argc, argv, config)) {
+        std::cerr << "Usage: " << argv[0]
+                << " --output Matchers.cpp [--header Matchers.h] [--namespace ns] name=regex..." << std::endl;
+        return 1;
+    }
+
+    std::vector<std::shared_ptr<const CompiledDFA> > automata;
+    for (const auto &pattern: config.patterns) {
+        try {
+            CompileOptions options;
+            options.engine = MatchEngine::DFA;
+            options.minimize = true;
+            const std::unique_ptr<const FiniteAutomaton> fa(
+                FiniteAutomaton::buildFromRegex(PostfixConverter::getPostfix(pattern.regex), options));
+            if (!fa || !fa->getCompiledDFA()) {
+                throw std::runtime_error("no deterministic automaton was produced");
+            }
+            automata.push_back(fa->getCompiledDFA());
+        } catch (const std::exception &e) {
+            std::cerr << std::format("Error: Pattern {} failed to compile: {}", pattern.name, e.what()) << std::endl;
+            return 1;
+        }
+    }
+
+    std::ostringstream source;
+    emitSource(source, config, automata);
+    if (!writeFile(config.output, source.str())) return 1;
+
+    if (!config.header.empty()) {
+        std::ostringstream header;
+        emitHeader(header, config);
+        if (!writeFile(config.header, header.str())) return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+enum class ExportFormat {
+    // Graphviz digraph; edges between the same two states are merged into one label.
+    Dot,
+    // {"kind", "start", "states": [{id, name, accepting}], "transitions": [{from, to, symbol}]},
+    // one transition per symbol, with symbol null for epsilon.
+    Json
+};
+
+// Labelled edge between two exported states; symbol '\0' is an epsilon transition.
+struct ExportEdge {
+    int from;
+    int to;
+    char symbol;
+};
+
+// Writes an automaton described by its state names, start state, accepting flags and edges.
+void writeAutomaton(std::ostream& os, ExportFormat format, const std::string& kind,
+                    const std::vector<std::string>& names, int start, const std::vector<bool>& accepting,
+                    const std::vector<ExportEdge>& edges);
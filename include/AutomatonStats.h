@@ -0,0 +1,52 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+// Filled in by FiniteAutomaton::buildFromRegex when CompileOptions::stats points at one.
+// Times are wall-clock milliseconds; stages that did not run for the chosen engine stay 0.
+struct CompileStats {
+    std::string engine;
+
+    double literalsMs = 0;
+    double glushkovMs = 0;
+    double thompsonMs = 0;
+    double lambdaScopeMs = 0;
+    double expansionMs = 0;
+    double subsetMs = 0;
+    double tableMs = 0;
+    double minimizeMs = 0;
+    double totalMs = 0;
+
+    size_t nfaNodes = 0;
+    size_t nfaEdges = 0;
+    // Sizes of the epsilon closures of all NFA nodes.
+    size_t closureTotal = 0;
+    size_t closureMax = 0;
+    size_t dfaStates = 0;
+    size_t expansionTableBytes = 0;
+    size_t tableBytes = 0;
+    // Largest working set of the compile: NFA, closures, expansion table and
+    // subset-construction clusters, which are all alive together.
+    size_t peakBytes = 0;
+
+    [[nodiscard]] std::string toJson() const;
+};
+
+// Accumulated over every FiniteAutomaton::process(word, stats) call it is passed to.
+struct MatchStats {
+    size_t calls = 0;
+    size_t accepted = 0;
+    size_t bytesProcessed = 0;
+    // Transitions actually taken; matching stops early once no state is alive.
+    size_t transitions = 0;
+    double totalMs = 0;
+
+    [[nodiscard]] std::string toJson() const;
+};
+
+// Wall time since `start`, in milliseconds.
+inline double elapsedMillis(const std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
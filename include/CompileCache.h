@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "CompileOptions.h"
+#include "FiniteAutomaton.h"
+
+// LRU cache of compiled automata keyed by normalized postfix and the options that
+// change the result. Keys are spread over independently locked shards, each holding
+// its share of the entry and byte limits. Handles are shared and immutable, so an
+// evicted automaton stays alive until its last user drops it.
+class CompileCache {
+public:
+    using Handle = std::shared_ptr<const FiniteAutomaton>;
+
+private:
+    struct Entry {
+        std::string key;
+        Handle automaton;
+        size_t bytes;
+    };
+
+    struct Shard {
+        std::mutex lock;
+        // Most recently used first.
+        std::list<Entry> order;
+        std::unordered_map<std::string, std::list<Entry>::iterator> index;
+        size_t bytes = 0;
+    };
+
+    std::vector<Shard> shards;
+    size_t entriesPerShard;
+    size_t bytesPerShard;
+    std::atomic<size_t> hits = 0;
+    std::atomic<size_t> misses = 0;
+
+    [[nodiscard]] static std::string makeKey(const std::string &postfix, const CompileOptions &options);
+
+    Shard &shardFor(const std::string &key);
+
+    void evict(Shard &shard);
+
+public:
+    explicit CompileCache(size_t maxEntries = 1024, size_t maxBytes = size_t{64} << 20, size_t shardCount = 16);
+
+    CompileCache(const CompileCache &) = delete;
+    CompileCache &operator=(const CompileCache &) = delete;
+
+    // Returns the cached automaton or compiles it with buildFromRegex. Compilation runs
+    // outside the shard lock, so options.log only sees the trace of a miss. Compile
+    // errors are rethrown and nothing is cached.
+    Handle get(const std::string &postfix, const CompileOptions &options = {});
+
+    // Rewrites a postfix regex into a canonical form of the same language: chains of
+    // '.' and '|' are flattened and re-associated to the left, and stacked unary
+    // operators are collapsed (a** -> a*, a?+ -> a*). Malformed input is returned as is.
+    [[nodiscard]] static std::string normalize(const std::string &postfix);
+
+    void clear();
+
+    [[nodiscard]] size_t size();
+
+    [[nodiscard]] size_t getBytes();
+
+    [[nodiscard]] size_t getHits() const { return hits; }
+
+    [[nodiscard]] size_t getMisses() const { return misses; }
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <iostream>
+
+struct CompileStats;
+
+enum class MatchEngine {
+    // Literal when the regex is a literal or an alternation of literals, then BitParallel
+    // when it fits in a machine word, as long as no DFA-only option (such as minimize) is
+    // requested; DFA otherwise.
+    Auto,
+    // Full subset construction up front, matched through a CompiledDFA table.
+    DFA,
+    // States are determinized on first visit while matching (see LazyDFA).
+    LazyDFA,
+    // Glushkov automaton simulated in a single uint64_t (see GlushkovMatcher);
+    // falls back to DFA for regexes with more than 63 symbol occurrences.
+    BitParallel,
+    // memcmp, a perfect hash and Aho-Corasick over the strings of a literal alternation
+    // (see LiteralMatcher); falls back to DFA for every other regex.
+    Literal
+};
+
+struct CompileOptions {
+    MatchEngine engine = MatchEngine::Auto;
+
+    // Run Hopcroft minimization on the subset-construction result (DFA engine only).
+    bool minimize = false;
+
+    // Threads used by subset construction (DFA engine); 0 means one per hardware thread.
+    unsigned threads = 1;
+
+    // Memory budget of the LazyDFA state cache.
+    size_t lazyCacheBytes = 1 << 20;
+
+    // Where the Thompson NFA edges are traced during compilation, whichever engine is
+    // picked. Off by default; for structured output use FiniteAutomaton::exportNFA /
+    // exportTo instead.
+    std::ostream* log = nullptr;
+
+    // Filled with per-stage timings and sizes when set (see AutomatonStats.h); nullptr skips all bookkeeping.
+    CompileStats* stats = nullptr;
+};
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class CompiledDFA {
+private:
+    // stateCount rows of classCount next-state entries, in a single allocation.
+    // Row `deadState` is an extra sink row that every missing transition leads to.
+    std::vector<uint32_t> table;
+    std::vector<uint64_t> acceptBits;
+    // Input byte -> equivalence class; identity (256 classes) until compressAlphabet().
+    std::array<uint8_t, 256> classMap{};
+
+    // Views used by the matching loops. They point into the vectors above, or into
+    // `image` for automata loaded from a file.
+    const uint32_t *rows = nullptr;
+    const uint64_t *accept = nullptr;
+    const uint8_t *classes = nullptr;
+    std::shared_ptr<const void> image;
+
+    uint32_t classCount = alphabetSize;
+    uint32_t stateCount = 0;
+    uint32_t startState = 0;
+    uint32_t deadState = 0;
+
+    CompiledDFA() = default;
+
+    void bindOwnedStorage();
+
+public:
+    static constexpr uint32_t alphabetSize = 256;
+
+    // Binary image layout (native byte order, all offsets from the start of the file):
+    //   [0, 64)      FileHeader
+    //   [64, 320)    class map, one byte per input byte
+    //   tableOffset  stateCount * classCount uint32 entries, 64-byte aligned
+    //   acceptOffset (stateCount + 63) / 64 uint64 words, 64-byte aligned
+    struct FileHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t byteOrder;
+        uint32_t stateCount;
+        uint32_t classCount;
+        uint32_t startState;
+        uint32_t deadState;
+        uint64_t tableOffset;
+        uint64_t acceptOffset;
+        uint64_t fileSize;
+        uint64_t reserved;
+    };
+
+    static constexpr char fileMagic[8] = {'R', 'E', 'G', 'E', 'x', 'D', 'F', 'A'};
+    static constexpr uint32_t fileVersion = 1;
+    static constexpr uint32_t fileByteOrder = 0x01020304;
+
+    CompiledDFA(uint32_t liveStates, uint32_t start);
+
+    // Rows of `classes` entries from the start, with every input byte mapped to one of
+    // them by `byteClasses` (no compressAlphabet() pass needed).
+    CompiledDFA(uint32_t liveStates, uint32_t start, const std::array<uint8_t, 256> &byteClasses,
+                uint32_t classes);
+
+    CompiledDFA(const CompiledDFA &) = delete;
+    CompiledDFA &operator=(const CompiledDFA &) = delete;
+
+    // Sets the entry of symbol's byte class; every byte is its own class until compressAlphabet().
+    void setTransition(uint32_t from, unsigned char symbol, uint32_t to) {
+        table[from * classCount + classMap[symbol]] = to;
+    }
+
+    // Merges bytes whose columns are identical in every row into one class and
+    // shrinks the rows to one entry per class. Bytes that never lead anywhere
+    // share a single reject class.
+    void compressAlphabet();
+
+    void setAccepting(const uint32_t state) {
+        acceptBits[state >> 6] |= uint64_t{1} << (state & 63);
+    }
+
+    [[nodiscard]] bool isAccepting(const uint32_t state) const {
+        return (accept[state >> 6] >> (state & 63)) & 1;
+    }
+
+    [[nodiscard]] uint32_t next(const uint32_t state, const unsigned char symbol) const {
+        return rows[state * classCount + classes[symbol]];
+    }
+
+    [[nodiscard]] uint8_t classOf(const unsigned char symbol) const { return classes[symbol]; }
+
+    [[nodiscard]] uint32_t getStartState() const { return startState; }
+    [[nodiscard]] uint32_t getDeadState() const { return deadState; }
+    [[nodiscard]] uint32_t getStateCount() const { return stateCount; }
+    [[nodiscard]] uint32_t getClassCount() const { return classCount; }
+
+    // Heap bytes held by this table; a mapped image is not counted (it lives in the page cache).
+    [[nodiscard]] size_t getMemoryFootprint() const {
+        return sizeof(*this) + table.capacity() * sizeof(uint32_t) + acceptBits.capacity() * sizeof(uint64_t);
+    }
+
+    // True when the tables live in a mapped file rather than in owned vectors.
+    [[nodiscard]] bool isMapped() const { return image != nullptr; }
+
+    [[nodiscard]] bool process(std::string_view word) const;
+
+    // process() for a batch, walking several words at once (see InterleavedMatch.h).
+    // Writes bit i of `bits` (bits[i / 64] >> (i % 64)) for words[i].
+    void processMany(std::span<const std::string_view> words, uint64_t *bits) const;
+
+    // State reached after reading the whole word (deadState as soon as it gets stuck).
+    [[nodiscard]] uint32_t finalState(std::string_view word) const;
+
+    // Length of the longest accepted prefix of text, or std::string_view::npos.
+    [[nodiscard]] size_t longestMatch(std::string_view text) const;
+
+    // Writes the binary image described above.
+    void save(std::ostream &os) const;
+    void save(const std::string &path) const;
+
+    // Maps a saved image read-only and matches directly from the mapping. The header
+    // and every transition entry are checked; throws std::runtime_error on a bad file.
+    static std::shared_ptr<const CompiledDFA> load(const std::string &path);
+};
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <vector>
+
+#include "StateCluster.h"
+
+// Result of subset construction: DFA state i is the NFA node set clusters[i],
+// state 0 is the start, and transitions[i][j] is the target on the j-th symbol
+// of the sorted alphabet (-1 when there is none).
+struct DeterminizedNFA {
+    std::vector<char> sigma;
+    ClusterIndex clusters;
+    std::vector<std::vector<int>> transitions;
+};
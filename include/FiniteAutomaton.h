@@ -6,10 +6,23 @@
 #include <memory>
 #include <format>
 #include <functional>
-#include <optional>
+#include <span>
+#include <string_view>
 #include <State.h>
 
-#include "StateNode.h"
+#include "AutomatonStats.h"
+#include "CompiledDFA.h"
+#include "CompileOptions.h"
+#include "DeterminizedNFA.h"
+#include "GlushkovMatcher.h"
+#include "LazyDFA.h"
+#include "LiteralExtractor.h"
+#include "LiteralMatcher.h"
+#include "NFASimulator.h"
+#include "StreamMatcher.h"
+#include "NFAGraph.h"
+#include "Setup.h"
+#include "StateCluster.h"
 
 class FiniteAutomaton {
 protected:
@@ -17,16 +30,26 @@ protected:
     std::vector<std::shared_ptr<State>> states;
     std::unordered_map<std::string, std::shared_ptr<State> > stateMap;
     std::shared_ptr<State> startState = nullptr;
+    std::shared_ptr<const CompiledDFA> compiled = nullptr;
+    std::shared_ptr<const LazyDFA> lazy = nullptr;
+    std::shared_ptr<const GlushkovMatcher> bitParallel = nullptr;
+    std::shared_ptr<const NFASimulator> nfa = nullptr;
+    std::shared_ptr<const LiteralMatcher> literal = nullptr;
+    RegexLiterals literals;
 
     bool inSigma(const char &symbol) const;
 
-    void setSigma(std::vector<std::string> const &sigma_);
+    // Sigma, states and transitions of a parsed definition file, as State objects.
+    void setDefinition(const Setup &setup);
 
-    void setStates(const std::vector<std::string> &stateLines);
+    // Matching engine of a nondeterministic definition: definitions of at most
+    // subsetConstructionStates states are determinized into `compiled` (while the DFA
+    // stays within maxDeterminizedStates), all others are simulated by `nfa`.
+    void compileNondeterministic(const Setup &setup);
 
-    void setTransitions(std::vector<std::string> const &transitions);
+    void compile();
 
-    void setStartState();
+    [[nodiscard]] size_t longestMatch(std::string_view text) const;
 
     explicit FiniteAutomaton(const std::string &file);
 
@@ -34,18 +57,30 @@ protected:
 
     bool isNondeterministic() const;
 
-    //FiniteAutomaton* getMinimizedVersion();
-
 public:
     FiniteAutomaton() = default;
 
+    // States point at each other through shared_ptr; copies would share (and the
+    // destructor would unlink) the same State objects.
+    FiniteAutomaton(const FiniteAutomaton&) = delete;
+    FiniteAutomaton& operator=(const FiniteAutomaton&) = delete;
+
     static void DFS(
-    const std::shared_ptr<StateNode>& origin,
-         const std::function<void(std::shared_ptr<StateNode>)>& action,
-         const std::function<bool(const std::pair<std::shared_ptr<StateNode>, std::optional<char>>&)>& validate);
+    const NFAGraph& graph,
+         int origin,
+         const std::function<void(int)>& action,
+         const std::function<bool(const StateEdge&)>& validate);
+
+    static std::vector<StateCluster> LambdaScope(const NFAGraph& graph);
 
-    static std::vector<StateCluster> LambdaScope(const std::vector<std::shared_ptr<StateNode>>& nodes);
-    static FiniteAutomaton* buildFromRegex(const std::string& postfix);
+    // Subset construction over the symbols of sigma_vec (sorted), starting from the closure of startNode.
+    // threads != 1 expands each BFS frontier on a pool (0 = one thread per core); numbering is unchanged.
+    // stats, when set, receives the closure, expansion and subset-construction figures.
+    static DeterminizedNFA determinize(const NFAGraph& graph, int startNode, const std::vector<char>& sigma_vec,
+                                       unsigned threads = 1, CompileStats* stats = nullptr);
+    static FiniteAutomaton* buildFromRegex(const std::string& postfix, const CompileOptions& options = {});
+
+    [[nodiscard]] FiniteAutomaton* getMinimizedVersion() const;
 
     void setSigma(const std::unordered_set<char> &sigma);
     std::unordered_set<char> getSigma(){
@@ -54,7 +89,63 @@ public:
 
     bool process(const std::string& word) const;
 
+    // Same result as process(word), also adding the call to `stats`. Kept separate so the
+    // plain overload carries no bookkeeping at all.
+    bool process(const std::string& word, MatchStats& stats) const;
+
+    // process() over a batch. Bit i of the result (result[i / 64] >> (i % 64)) is set when
+    // words[i] is accepted. The compiled and bit-parallel engines walk several words at once
+    // so their table loads overlap. threads != 1 splits batches of at least
+    // 2 * batchChunkWords words over a pool (0 = one thread per core).
+    [[nodiscard]] std::vector<uint64_t> processMany(std::span<const std::string_view> words,
+                                                    unsigned threads = 1) const;
+
+    static constexpr size_t batchChunkWords = 1024;
+
+    // Nondeterministic definition files up to this many states are determinized when loaded.
+    static constexpr size_t subsetConstructionStates = 256;
+    // Determinization gives up (and the NFA is simulated) beyond this many DFA states.
+    static constexpr size_t maxDeterminizedStates = size_t{1} << 16;
+
+    // Throws for engines without a resumable state (LazyDFA, simulated NFAs). A literal
+    // matcher streams through its trie, built into a table on every call.
+    [[nodiscard]] StreamMatcher streamMatcher() const;
+
+    bool processFile(const std::string& path) const;
+
+    // Table of a DFA-engine automaton or of a determinized definition file; nullptr for the
+    // other engines and for simulated NFAs.
+    [[nodiscard]] std::shared_ptr<const CompiledDFA> getCompiledDFA() const {
+        return compiled;
+    }
+
+    // Writes the compiled DFA in the CompiledDFA binary format; throws for other engines.
+    void save(const std::string& path) const;
+
+    // Matcher over a saved DFA, used straight from the mapped file. Only the compiled
+    // table is restored, so there are no State objects to print or minimize.
+    static FiniteAutomaton* load(const std::string& path);
+
+    // Automaton from a definition file (see Setup). A deterministic definition is compiled
+    // straight into a CompiledDFA with no State objects, like load(); a nondeterministic
+    // one keeps its states and matches through compileNondeterministic()'s engine.
+    static FiniteAutomaton* loadDefinition(const std::string& path);
+
+    // Leftmost-longest, non-overlapping, non-empty matches as [begin, end) offsets.
+    [[nodiscard]] std::vector<std::pair<size_t, size_t>> search(std::string_view text) const;
+
+    // Writes the states and transitions (or, for a loaded automaton, the compiled table without
+    // its dead state). Throws for the lazy and bit-parallel engines, which keep no explicit graph.
+    void exportTo(std::ostream& os, ExportFormat format) const;
+
+    // Writes the Thompson NFA of a postfix regex.
+    static void exportNFA(const std::string& postfix, std::ostream& os, ExportFormat format);
+
+    // Approximate heap bytes owned by the automaton and its matching engine.
+    [[nodiscard]] size_t getMemoryFootprint() const;
+
     friend std::ostream& operator<<(std::ostream& os, const FiniteAutomaton& fa);
 
-    ~FiniteAutomaton() = default;
+    // Breaks the shared_ptr cycles between states (loops, back edges) so they are freed.
+    ~FiniteAutomaton();
 };
\ No newline at end of file
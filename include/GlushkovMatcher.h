@@ -0,0 +1,65 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Epsilon-free Glushkov automaton simulated bit-parallel in one uint64_t.
+// Bit 0 is the initial state, bits 1..63 are the positions (symbol occurrences)
+// of the regex; the active set is advanced with one table OR per byte of state
+// and one AND with the mask of the input symbol.
+class GlushkovMatcher {
+private:
+    static constexpr int chunkBits = 8;
+
+    std::array<uint64_t, 256> symbolMasks{};
+    // followTables[k][b] = union of follow sets of the positions in bit chunk k set in b.
+    std::vector<std::array<uint64_t, 1 << chunkBits>> followTables;
+    uint64_t acceptMask = 0;
+    int positions = 0;
+
+    GlushkovMatcher() = default;
+
+public:
+    static constexpr int maxPositions = 63;
+
+    // Returns nullptr when the regex has more than maxPositions symbol occurrences.
+    static std::shared_ptr<GlushkovMatcher> build(const std::string& postfix);
+
+    [[nodiscard]] uint64_t step(const uint64_t active, const unsigned char symbol) const {
+        uint64_t next = 0;
+        for (size_t k = 0; k < followTables.size(); ++k) {
+            next |= followTables[k][(active >> (k * chunkBits)) & 0xff];
+        }
+        return next & symbolMasks[symbol];
+    }
+
+    [[nodiscard]] static constexpr uint64_t initialState() {
+        return 1;
+    }
+
+    [[nodiscard]] bool isAccepting(const uint64_t active) const {
+        return (active & acceptMask) != 0;
+    }
+
+    [[nodiscard]] int getPositionCount() const {
+        return positions;
+    }
+
+    [[nodiscard]] size_t getMemoryFootprint() const {
+        return sizeof(*this) + followTables.capacity() * sizeof(followTables[0]);
+    }
+
+    [[nodiscard]] bool process(std::string_view word) const;
+
+    // Batch form of process(), writing a bitmap like CompiledDFA::processMany. Words are
+    // walked one at a time: step() already issues its table loads in parallel.
+    void processMany(std::span<const std::string_view> words, uint64_t *bits) const;
+
+    // Length of the longest accepted prefix of text, or std::string_view::npos.
+    [[nodiscard]] size_t longestMatch(std::string_view text) const;
+};
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+namespace InterleavedMatchDetail {
+    // Words walked side by side.
+    constexpr size_t lanes = 8;
+    // Bytes every lane advances between two checks for finished words.
+    constexpr size_t roundSteps = 4;
+    // Shorter words are walked one after another: their chains are short enough for the
+    // CPU to overlap consecutive ones by itself, and a lane would mostly sit idle.
+    constexpr size_t defaultMinLaneLength = 16;
+    // Tables up to this size stay in L1, where a load is too cheap for lanes to pay off.
+    constexpr size_t cacheResidentBytes = size_t{32} << 10;
+    // Results are gathered as one byte per word and packed into the bitmap per block, so
+    // consecutive results do not wait on each other's read-modify-write of a bitmap word.
+    constexpr size_t blockWords = 1024;
+}
+
+// Matches a batch of words with several walks in flight at once. Each word's walk is a
+// chain of dependent table loads; the chains of different lanes are independent, so in
+// the fixed-width inner loop their loads overlap instead of waiting on each other. The
+// dead state absorbs, so a lane that dies keeps stepping harmlessly until the round ends.
+//
+// Sets bit i of `bits` (bits[i / 64] >> (i % 64)) when words[i] is accepted. Words shorter
+// than minLaneLength are walked one at a time; SIZE_MAX turns the lanes off altogether.
+template<typename StateId, typename Step, typename Accepts>
+void interleavedMatch(const std::span<const std::string_view> words, uint64_t *bits, const StateId start,
+                      const StateId dead, Step step, Accepts accepts,
+                      const size_t minLaneLength = InterleavedMatchDetail::defaultMinLaneLength) {
+    using namespace InterleavedMatchDetail;
+
+    uint8_t accepted[blockWords];
+
+    for (size_t base = 0; base < words.size(); base += blockWords) {
+        const size_t count = words.size() - base < blockWords ? words.size() - base : blockWords;
+        const std::span<const std::string_view> block = words.subspan(base, count);
+
+        auto finish = [&](const size_t index, const StateId state) {
+            accepted[index] = state != dead && accepts(state);
+        };
+
+        const unsigned char *position[lanes];
+        size_t remaining[lanes];
+        size_t index[lanes];
+        StateId state[lanes];
+        size_t nextWord = 0;
+
+        // Loads the next long word into a lane; short words are matched on the spot.
+        auto refill = [&](const size_t lane) {
+            while (nextWord < count) {
+                const std::string_view word = block[nextWord++];
+                const auto *data = reinterpret_cast<const unsigned char *>(word.data());
+                if (word.size() < minLaneLength) {
+                    StateId current = start;
+                    for (size_t i = 0; i < word.size() && current != dead; ++i) {
+                        current = step(current, data[i]);
+                    }
+                    finish(nextWord - 1, current);
+                    continue;
+                }
+                position[lane] = data;
+                remaining[lane] = word.size();
+                index[lane] = nextWord - 1;
+                state[lane] = start;
+                return true;
+            }
+            return false;
+        };
+
+        size_t filled = 0;
+        while (filled < lanes && refill(filled)) {
+            ++filled;
+        }
+
+        while (filled == lanes) {
+            for (size_t i = 0; i < roundSteps; ++i) {
+                for (size_t lane = 0; lane < lanes; ++lane) {
+                    const bool inWord = i < remaining[lane];
+                    const StateId next = step(state[lane], position[lane][inWord ? i : 0]);
+                    state[lane] = inWord ? next : state[lane];
+                }
+            }
+
+            for (size_t lane = 0; lane < lanes; ++lane) {
+                const size_t taken = remaining[lane] < roundSteps ? remaining[lane] : roundSteps;
+                position[lane] += taken;
+                remaining[lane] -= taken;
+            }
+
+            for (size_t lane = 0; lane < lanes && filled == lanes; ++lane) {
+                if (remaining[lane] != 0 && state[lane] != dead) {
+                    continue;
+                }
+                finish(index[lane], state[lane]);
+                if (!refill(lane)) {
+                    // Out of words: move the last lane here and finish the rest one by one.
+                    --filled;
+                    position[lane] = position[filled];
+                    remaining[lane] = remaining[filled];
+                    index[lane] = index[filled];
+                    state[lane] = state[filled];
+                }
+            }
+        }
+
+        for (size_t lane = 0; lane < filled; ++lane) {
+            StateId current = state[lane];
+            for (size_t i = 0; i < remaining[lane] && current != dead; ++i) {
+                current = step(current, position[lane][i]);
+            }
+            finish(index[lane], current);
+        }
+
+        // base is a multiple of 64, so every packed word starts a bitmap word.
+        for (size_t i = 0; i < count; i += 64) {
+            uint64_t packed = 0;
+            const size_t end = count - i < 64 ? count - i : 64;
+            for (size_t j = 0; j < end; ++j) {
+                packed |= static_cast<uint64_t>(accepted[i + j]) << j;
+            }
+            bits[(base + i) >> 6] = packed;
+        }
+    }
+}
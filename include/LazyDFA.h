@@ -0,0 +1,79 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+#include "NFAGraph.h"
+#include "StateCluster.h"
+
+// DFA built on demand while matching. States are subsets of the NFA computed on
+// first visit and cached; when the cache outgrows its memory budget it is flushed,
+// and when flushes come too often the remaining input is matched by NFA simulation.
+class LazyDFA {
+private:
+    static constexpr int32_t unknownState = -1;
+    static constexpr int32_t deadState = -2;
+    static constexpr uint8_t rejectClass = 0;
+
+    NFAGraph graph;
+    // Every symbol labelling an NFA edge has its own class; all other bytes share rejectClass.
+    std::array<uint8_t, 256> classMap{};
+    std::vector<unsigned char> classSymbol;
+    int endNode;
+    StateCluster startCluster;
+    size_t maxStates;
+    size_t memoryBudget;
+
+    mutable std::mutex cacheMutex;
+    mutable ClusterIndex states;
+    mutable std::vector<int32_t> rows;
+    mutable std::vector<bool> accepting;
+    mutable size_t flushCount = 0;
+    // Input bytes consumed since the last flush, over all calls. A full cache is flushed
+    // only once it has served maxStates bytes; before that it is thrashing.
+    mutable size_t consumedSinceFlush = 0;
+
+    void closeOver(StateCluster &cluster) const;
+
+    [[nodiscard]] StateCluster step(const StateCluster &cluster, unsigned char symbol) const;
+
+    [[nodiscard]] size_t classCount() const {
+        return classSymbol.size();
+    }
+
+    int addState(const StateCluster &cluster) const;
+
+    void flush() const;
+
+    // NFA simulation of text[from..) starting from `current`; same result convention as run().
+    [[nodiscard]] size_t simulate(StateCluster current, std::string_view text, size_t from, size_t matched,
+                                  bool longest) const;
+
+    // With `longest`, returns the length of the longest accepted prefix; otherwise
+    // text.size() if the whole text is accepted. std::string_view::npos when nothing matches.
+    [[nodiscard]] size_t run(std::string_view text, bool longest) const;
+
+public:
+    LazyDFA(NFAGraph graph, int startNode, int endNode, size_t memoryBudget);
+
+    LazyDFA(const LazyDFA &) = delete;
+
+    LazyDFA &operator=(const LazyDFA &) = delete;
+
+    [[nodiscard]] bool process(std::string_view word) const;
+
+    // Length of the longest accepted prefix of text, or std::string_view::npos.
+    [[nodiscard]] size_t longestMatch(std::string_view text) const;
+
+    [[nodiscard]] size_t getCachedStates() const;
+
+    [[nodiscard]] size_t getFlushCount() const;
+
+    // NFA plus the full cache budget, i.e. the most this matcher can grow to.
+    [[nodiscard]] size_t getMemoryFootprint() const {
+        return sizeof(*this) + graph.size() * sizeof(int) + graph.edgeCount() * sizeof(StateEdge) + memoryBudget;
+    }
+};
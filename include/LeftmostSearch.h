@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace LeftmostSearchDetail {
+    // Up to this many live threads a duplicate state is found by scanning them; beyond it
+    // the states of the step are kept in a hash set.
+    constexpr size_t scannedThreads = 16;
+}
+
+// Leftmost-longest, non-overlapping, non-empty matches of a deterministic automaton, as
+// [begin, end) offsets, found in one left-to-right pass instead of one longest match per
+// start. A thread is seeded at every position and all live threads advance together;
+// threads in the same state share their future, so only the earliest-started one is kept
+// and the work per byte is bounded by the number of states live at once. Once a thread
+// accepts, no new thread is seeded and later-started ones are dropped; the match is
+// reported when the last thread dies, and the scan resumes at its end (bytes read past
+// the end while looking for a longer match are read again).
+//
+// nextStart(position) returns the first position >= position where a match may begin,
+// or std::string_view::npos when none can; it is asked only while no thread is alive.
+template<typename StateId, typename Step, typename Accepts, typename NextStart>
+std::vector<std::pair<size_t, size_t>> leftmostLongestSearch(const std::string_view text, const StateId start,
+                                                             const StateId dead, Step step, Accepts accepts,
+                                                             NextStart nextStart) {
+    using namespace LeftmostSearchDetail;
+
+    struct Thread {
+        StateId state;
+        size_t start;
+    };
+
+    std::vector<std::pair<size_t, size_t>> spans;
+    // Ordered by start, so the first thread to accept in a step is the leftmost one.
+    std::vector<Thread> threads, advanced;
+    std::unordered_set<StateId> seen;
+
+    auto duplicate = [&](const StateId state) {
+        if (advanced.size() < scannedThreads) {
+            for (const Thread &thread: advanced) {
+                if (thread.state == state) return true;
+            }
+            return false;
+        }
+        if (seen.empty()) {
+            for (const Thread &thread: advanced) seen.insert(thread.state);
+        }
+        return !seen.insert(state).second;
+    };
+
+    size_t matchStart = std::string_view::npos, matchEnd = 0;
+    size_t position = 0;
+    while (true) {
+        if (threads.empty() || position == text.size()) {
+            if (matchStart != std::string_view::npos) {
+                spans.emplace_back(matchStart, matchEnd);
+                position = matchEnd;
+                matchStart = std::string_view::npos;
+                threads.clear();
+            }
+            if (!threads.empty() || position >= text.size()) break;
+            position = nextStart(position);
+            if (position == std::string_view::npos || position >= text.size()) break;
+        }
+
+        if (matchStart == std::string_view::npos) {
+            threads.push_back({start, position});
+        }
+
+        const auto symbol = static_cast<unsigned char>(text[position]);
+        advanced.clear();
+        seen.clear();
+        for (const Thread &thread: threads) {
+            if (matchStart != std::string_view::npos && thread.start > matchStart) break;
+
+            const StateId next = step(thread.state, symbol);
+            if (next == dead || duplicate(next)) continue;
+
+            advanced.push_back({next, thread.start});
+            if (accepts(next)) {
+                matchStart = thread.start;
+                matchEnd = position + 1;
+            }
+        }
+        std::swap(threads, advanced);
+        ++position;
+    }
+
+    return spans;
+}
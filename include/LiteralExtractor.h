@@ -0,0 +1,23 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Literal strings every match of a regex is known to contain.
+struct RegexLiterals {
+    std::string prefix;
+    std::string suffix;
+    std::string required;
+    // Every string the regex matches, sorted, when it is a literal or an alternation of
+    // literals (foo|bar|baz) with at most LiteralExtractor::maxLanguageSize strings; empty otherwise.
+    std::vector<std::string> language;
+};
+
+class LiteralExtractor {
+public:
+    static constexpr size_t maxLanguageSize = 1024;
+
+    LiteralExtractor() = default;
+
+    [[nodiscard]] static RegexLiterals extract(const std::string& postfix);
+};
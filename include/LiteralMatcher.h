@@ -0,0 +1,82 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "CompiledDFA.h"
+
+// Matcher for regexes that are a literal or an alternation of literals, with no automaton
+// built from the regex. A single literal is matched by a length check and memcmp and searched
+// with std::string_view::find. A set is matched through a perfect hash of its strings
+// (hash and displace: every bucket of keys gets the seed that sends them to free slots, so
+// a lookup is one hash, two loads and one comparison) and searched with an Aho-Corasick
+// automaton over the trie of the strings.
+class LiteralMatcher {
+private:
+    static constexpr uint32_t noEntry = UINT32_MAX;
+
+    // Sorted and unique.
+    std::vector<std::string> literals;
+    size_t minLength = 0;
+    size_t maxLength = 0;
+
+    std::vector<uint32_t> bucketSeeds;
+    // Index into literals, or noEntry.
+    std::vector<uint32_t> slots;
+
+    // Every byte used by a literal has its own class; all other bytes share class 0.
+    std::array<uint8_t, 256> classMap{};
+    std::vector<unsigned char> classSymbol;
+    // Trie of the literals (node 0 is the empty string); children[node * classes + class]
+    // is the child node, or noEntry.
+    std::vector<uint32_t> children;
+    // Aho-Corasick transitions: the deepest trie node that is a suffix of node + byte.
+    std::vector<uint32_t> next;
+    std::vector<uint32_t> depth;
+    std::vector<bool> terminal;
+    // Length of the longest non-empty literal ending at the node (0 when none does).
+    std::vector<uint32_t> longestOutput;
+
+    LiteralMatcher() = default;
+
+    [[nodiscard]] size_t classCount() const {
+        return classSymbol.size();
+    }
+
+    [[nodiscard]] uint32_t slotOf(std::string_view word) const;
+
+    void buildHash();
+
+    void buildTrie();
+
+public:
+    // Returns nullptr when `literals` is empty.
+    static std::shared_ptr<LiteralMatcher> build(std::vector<std::string> literals);
+
+    [[nodiscard]] bool process(std::string_view word) const;
+
+    // Batch form of process(), writing a bitmap like CompiledDFA::processMany.
+    void processMany(std::span<const std::string_view> words, uint64_t *bits) const;
+
+    // Length of the longest literal text starts with, or std::string_view::npos.
+    [[nodiscard]] size_t longestMatch(std::string_view text) const;
+
+    // Leftmost-longest, non-overlapping, non-empty matches as [begin, end) offsets, like
+    // FiniteAutomaton::search, in one pass over text.
+    [[nodiscard]] std::vector<std::pair<size_t, size_t> > search(std::string_view text) const;
+
+    // The trie as a DFA table, for callers that need resumable state (StreamMatcher).
+    [[nodiscard]] std::shared_ptr<const CompiledDFA> toCompiledDFA() const;
+
+    [[nodiscard]] size_t getLiteralCount() const {
+        return literals.size();
+    }
+
+    [[nodiscard]] size_t getMemoryFootprint() const;
+};
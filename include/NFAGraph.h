@@ -0,0 +1,59 @@
+#pragma once
+
+#include <format>
+#include <ostream>
+#include <span>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "AutomatonExport.h"
+
+// Outgoing transition of an NFA node; symbol '\0' marks a lambda (epsilon) transition.
+struct StateEdge {
+    int target;
+    char symbol;
+};
+
+// Arena owning every node and edge of an epsilon-NFA. Nodes are dense int ids;
+// after finalize() the edges of node i are edges[edgeOffsets[i] .. edgeOffsets[i + 1]).
+class NFAGraph {
+private:
+    std::vector<int> edgeOffsets;
+    std::vector<StateEdge> edges;
+    std::vector<std::tuple<int, int, char>> pending;
+    int nodeCount = 0;
+
+public:
+    NFAGraph() = default;
+
+    int addNode() {
+        return nodeCount++;
+    }
+
+    void connect(const int from, const int to, const char symbol = '\0') {
+        pending.emplace_back(from, to, symbol);
+    }
+
+    // Packs the edges added with connect() into CSR layout; may be called again after more edges are added.
+    void finalize();
+
+    [[nodiscard]] int size() const {
+        return nodeCount;
+    }
+
+    [[nodiscard]] size_t edgeCount() const {
+        return edges.size();
+    }
+
+    [[nodiscard]] std::span<const StateEdge> connections(const int node) const {
+        return {edges.data() + edgeOffsets[node], edges.data() + edgeOffsets[node + 1]};
+    }
+
+    // Writes the finalized graph (nodes named "(id)") with startNode as the start and endNode accepting.
+    void exportTo(std::ostream& os, ExportFormat format, int startNode, int endNode) const;
+
+    [[nodiscard]] static std::string toString(const int node) {
+        return std::format("({})", node);
+    }
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "CompiledDFA.h"
+#include "Setup.h"
+
+// Epsilon-free NFA of a definition file, simulated with one bit per state. Every byte
+// advances all active states at once: the successor lists of the byte's class are
+// ORed into the next bitset, so a state reached along several paths is kept once and
+// the cost per byte is bounded by the active states' edges, never by the path count.
+class NFASimulator {
+private:
+    // Every symbol labelling a transition has its own class; all other bytes share class 0,
+    // whose successor lists are empty. classSymbol holds one byte of each class.
+    std::array<uint8_t, 256> classMap{};
+    std::vector<unsigned char> classSymbol;
+    uint32_t stateCount = 0;
+    size_t wordCount = 0;
+    // Successors of state s on class c: targets[offsets[c * stateCount + s] .. offsets[c * stateCount + s + 1]).
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> targets;
+    std::vector<uint64_t> startSet;
+    std::vector<uint64_t> acceptSet;
+
+    [[nodiscard]] size_t classCount() const {
+        return classSymbol.size();
+    }
+
+    // Writes the successors of `active` on `symbol` into `next`; false when none remain.
+    bool step(const uint64_t *active, unsigned char symbol, uint64_t *next) const;
+
+    [[nodiscard]] bool isAccepting(const uint64_t *active) const;
+
+    // With `longest`, returns the length of the longest accepted prefix; otherwise
+    // text.size() if the whole text is accepted. std::string_view::npos when nothing matches.
+    // current and next are scratch buffers, resized as needed.
+    size_t run(std::string_view text, bool longest, std::vector<uint64_t> &current,
+               std::vector<uint64_t> &next) const;
+
+public:
+    explicit NFASimulator(const Setup &setup);
+
+    [[nodiscard]] bool process(std::string_view word) const;
+
+    // Batch form of process(), writing a bitmap like CompiledDFA::processMany.
+    void processMany(std::span<const std::string_view> words, uint64_t *bits) const;
+
+    // Length of the longest accepted prefix of text, or std::string_view::npos.
+    [[nodiscard]] size_t longestMatch(std::string_view text) const;
+
+    // Subset construction into a table with one byte class per symbol. Returns nullptr as
+    // soon as more than maxStates subsets are reachable.
+    [[nodiscard]] std::shared_ptr<CompiledDFA> determinize(size_t maxStates) const;
+
+    [[nodiscard]] uint32_t getStateCount() const {
+        return stateCount;
+    }
+
+    [[nodiscard]] size_t getMemoryFootprint() const {
+        return sizeof(*this) + offsets.capacity() * sizeof(uint32_t) + targets.capacity() * sizeof(uint32_t)
+               + (startSet.capacity() + acceptSet.capacity()) * sizeof(uint64_t);
+    }
+};
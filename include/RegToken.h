@@ -3,35 +3,32 @@
 #include <stdexcept>
 #include <stack>
 #include <unordered_set>
-#include <memory>
-#include <utility>
-#include "StateNode.h"
+#include "NFAGraph.h"
+#include "RegexSyntax.h"
 
 class RegToken {
 private:
     static bool isBinary(const char c) {
-        const std::unordered_set<char> unaryOperators = {'|', '.'};
-        return unaryOperators.contains(c);
+        return RegexSyntax::isBinary(c);
     }
 
     static bool isOperator(const char c) {
-        const std::unordered_set<char> symbols = {'.', '*', '|', '+', '?'};
-        return symbols.contains(c);
+        return RegexSyntax::isOperator(c);
     }
 
 public:
-    std::shared_ptr<StateNode> startNode;
-    std::shared_ptr<StateNode> endNode;
+    int startNode = -1;
+    int endNode = -1;
 
     RegToken() = default;
 
-    RegToken(std::shared_ptr<StateNode> startNode, std::shared_ptr<StateNode> endNode)
-        : startNode(std::move(startNode)), endNode(std::move(endNode)) {
+    RegToken(const int startNode, const int endNode)
+        : startNode(startNode), endNode(endNode) {
     }
 
-    RegToken(char symbol, int &i);
+    RegToken(NFAGraph &graph, char symbol);
 
-    RegToken(int &i, const std::shared_ptr<RegToken> &lhs, char operation = 'x', const std::shared_ptr<RegToken>&rhs = nullptr);
+    RegToken(NFAGraph &graph, const RegToken &lhs, char operation = 'x', const RegToken &rhs = RegToken(-1, -1));
 
-    static std::shared_ptr<RegToken> getENFAToken(const std::string& postfix, int& nodesCount);
+    static RegToken getENFAToken(const std::string& postfix, NFAGraph& graph);
 };
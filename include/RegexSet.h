@@ -0,0 +1,38 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "CompiledDFA.h"
+
+// Many regexes compiled into one DFA. The Thompson NFAs of all patterns hang off a
+// shared start node, and each DFA state records which patterns' end nodes it contains,
+// so a single pass over the input reports every pattern that accepts it.
+class RegexSet {
+private:
+    std::vector<std::string> patterns;
+    std::shared_ptr<const CompiledDFA> dfa = nullptr;
+    std::vector<std::vector<int>> matchesByState;
+
+public:
+    RegexSet() = default;
+
+    // Adds a regex in postfix notation and returns its pattern id.
+    int add(const std::string& postfix);
+
+    // Builds the combined automaton; must be called again after add().
+    void compile();
+
+    // Ids of the patterns accepting the whole word, in increasing order.
+    [[nodiscard]] std::vector<int> matches(std::string_view word) const;
+
+    [[nodiscard]] size_t size() const {
+        return patterns.size();
+    }
+
+    [[nodiscard]] size_t getStateCount() const {
+        return dfa ? dfa->getStateCount() : 0;
+    }
+};
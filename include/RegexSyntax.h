@@ -0,0 +1,72 @@
+#pragma once
+
+// Operators of the regex syntax and the infix-to-postfix rules, shared by PostfixConverter at
+// run time and StaticRegex at compile time. '.' is the explicit concatenation operator.
+namespace RegexSyntax {
+    constexpr bool isUnary(const char c) {
+        return c == '?' || c == '*' || c == '+';
+    }
+
+    constexpr bool isBinary(const char c) {
+        return c == '.' || c == '|';
+    }
+
+    constexpr bool isOperator(const char c) {
+        return isBinary(c) || isUnary(c);
+    }
+
+    // Anything but an operator or a parenthesis is matched literally.
+    constexpr bool isSymbol(const char c) {
+        return !(isOperator(c) || c == '(' || c == ')');
+    }
+
+    // Shunting Yard precedence; 0 for everything that is not an operator.
+    constexpr int priority(const char c) {
+        switch (c) {
+            case '|': return 1;
+            case '.': return 2;
+            case '?':
+            case '*':
+            case '+': return 3;
+            default: return 0;
+        }
+    }
+
+    // Whether an explicit '.' goes between two adjacent characters of the infix pattern.
+    constexpr bool concatenates(const char current, const char next) {
+        return (isSymbol(current) || current == ')' || isUnary(current)) && (isSymbol(next) || next == '(');
+    }
+
+    // Shunting Yard over an infix pattern that already has its '.' operators, calling
+    // emit(c) for every character of the postfix form. `operators` is any empty stack of
+    // char with push, pop, top and empty.
+    template<typename Infix, typename OperatorStack, typename Emit>
+    constexpr void toPostfix(const Infix &infix, OperatorStack &operators, Emit emit) {
+        for (const char c: infix) {
+            if (c == '(') {
+                operators.push(c);
+            } else if (c == ')') {
+                while (!operators.empty() && operators.top() != '(') {
+                    emit(operators.top());
+                    operators.pop();
+                }
+                if (!operators.empty()) {
+                    operators.pop();
+                }
+            } else if (priority(c) > 0) {
+                while (!operators.empty() && priority(operators.top()) >= priority(c)) {
+                    emit(operators.top());
+                    operators.pop();
+                }
+                operators.push(c);
+            } else {
+                emit(c);
+            }
+        }
+
+        while (!operators.empty()) {
+            emit(operators.top());
+            operators.pop();
+        }
+    }
+}
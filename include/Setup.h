@@ -1,19 +1,56 @@
 #pragma once
 
-#include <vector>
+#include <cstdint>
 #include <string>
+#include <string_view>
+#include <vector>
 
+// Automaton definition file:
+//
+//     Sigma            one symbol per line (its first character)
+//     States           name[, S][, F]    S marks the initial state, F a final one
+//     Transitions      from, symbol, to
+//     End
+//
+// Each section runs until the next header or `End`; `#` starts a comment line.
+// The file is mapped read-only and tokenized in one pass with std::string_view.
+// State names are interned into dense ids in declaration order and transitions are
+// kept as id triples, so nothing is copied per line. Configuration errors are
+// reported through UserWarn.
 class Setup {
-    std::vector<std::string> sigma;
+public:
+    static constexpr uint32_t noState = UINT32_MAX;
+
+    struct Transition {
+        uint32_t from;
+        uint32_t to;
+        char symbol;
+    };
+
+private:
+    std::vector<char> sigma;
     std::vector<std::string> states;
-    std::vector<std::string> transitions;
+    std::vector<bool> finalStates;
+    uint32_t initialState = noState;
+    std::vector<Transition> transitions;
+
+    Setup() = default;
+
+    void parse(std::string_view text);
 
 public:
     explicit Setup(const std::string& file);
 
-    [[nodiscard]] const std::vector<std::string>& getSigma() const;
+    // Parses a definition that is already in memory.
+    static Setup fromText(std::string_view text);
+
+    [[nodiscard]] const std::vector<char>& getSigma() const;
+    // State names, indexed by id.
     [[nodiscard]] const std::vector<std::string>& getStates() const;
-    [[nodiscard]] const std::vector<std::string>& getTransitions() const;
+    [[nodiscard]] const std::vector<bool>& getFinalStates() const;
+    // Id of the state marked S, or noState.
+    [[nodiscard]] uint32_t getInitialState() const;
+    [[nodiscard]] const std::vector<Transition>& getTransitions() const;
 
     ~Setup() = default;
-};
\ No newline at end of file
+};
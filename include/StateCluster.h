@@ -1,42 +1,50 @@
 #pragma once
 
-#include <set>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
 #include <sstream>
+#include <unordered_map>
+#include <vector>
 
-#include "StateNode.h"
-
-class StateNode;
-class StateAssembler;
+#include "NFAGraph.h"
 
+// Set of NFA node ids stored as a fixed-width bitset (one bit per node).
 class StateCluster {
 private:
-    std::set<std::shared_ptr<StateNode>> states;
-    std::set<int> state_ids;
+    std::vector<uint64_t> words;
+    mutable uint64_t hashValue = 0;
+    mutable bool hashed = false;
 
-public:
+    [[nodiscard]] uint64_t computeHash() const;
 
+public:
     StateCluster() = default;
-    explicit StateCluster(const std::set<int>& ids) : state_ids(ids) {}
 
-    std::set<std::shared_ptr<StateNode>> getStates() {
-        return states;
+    explicit StateCluster(const size_t width) : words((width + 63) / 64, 0) {}
+
+    void insert(const int id) {
+        words[id >> 6] |= uint64_t{1} << (id & 63);
+        hashed = false;
     }
 
-    explicit StateCluster(const std::vector<std::shared_ptr<StateNode>>& _states) {
-        for (const auto& state : _states) {
-            states.insert(state);
-            state_ids.insert(state->id);
-        }
+    [[nodiscard]] bool contains(const int id) const {
+        return (words[id >> 6] >> (id & 63)) & 1;
     }
 
-    bool containsState(const std::shared_ptr<StateNode>& node) const {
-        return state_ids.contains(node->id);
+    // Word-wise OR; both clusters must have been built for the same node count.
+    StateCluster& unionWith(const StateCluster& other) {
+        for (size_t i = 0; i < words.size(); ++i) {
+            words[i] |= other.words[i];
+        }
+        hashed = false;
+        return *this;
     }
 
     [[nodiscard]] StateCluster unionize(const StateCluster& other) const {
-        std::vector<std::shared_ptr<StateNode>> combined(states.begin(), states.end());
-        combined.insert(combined.end(), other.states.begin(), other.states.end());
-        return StateCluster(combined);
+        StateCluster result(*this);
+        return result.unionWith(other);
     }
 
     bool operator!=(const StateCluster& other) const {
@@ -44,21 +52,112 @@ public:
     }
 
     bool operator==(const StateCluster& other) const {
-        return state_ids == other.state_ids;
+        return words.size() == other.words.size() && hash() == other.hash()
+               && std::memcmp(words.data(), other.words.data(), words.size() * sizeof(uint64_t)) == 0;
     }
 
-    bool operator<(const StateCluster& other) const {
-        return state_ids < other.state_ids;
+    [[nodiscard]] uint64_t hash() const {
+        if (!hashed) {
+            hashValue = computeHash();
+            hashed = true;
+        }
+        return hashValue;
+    }
+
+    // Calls action(id) for every node id in the cluster, in increasing order.
+    template<typename Action>
+    void forEach(Action&& action) const {
+        for (size_t i = 0; i < words.size(); ++i) {
+            for (uint64_t word = words[i]; word != 0; word &= word - 1) {
+                action(static_cast<int>(i * 64 + std::countr_zero(word)));
+            }
+        }
     }
 
     [[nodiscard]] std::string toString() const;
 
-    [[nodiscard]] auto begin() const { return states.begin(); }
-    [[nodiscard]] auto end() const { return states.end(); }
+    [[nodiscard]] size_t count() const {
+        size_t total = 0;
+        for (const uint64_t word : words) {
+            total += std::popcount(word);
+        }
+        return total;
+    }
+
+    [[nodiscard]] size_t byteSize() const {
+        return words.size() * sizeof(uint64_t);
+    }
 
     [[nodiscard]] bool isEmpty() const {
-        return states.empty();
+        for (const uint64_t word : words) {
+            if (word != 0) return false;
+        }
+        return true;
+    }
+
+    [[nodiscard]] StateCluster stepWith(char symbol, const NFAGraph& graph) const;
+};
+
+struct StateClusterHash {
+    size_t operator()(const StateCluster& cluster) const {
+        return cluster.hash();
+    }
+};
+
+// Flat open-addressing table assigning dense indices to distinct clusters.
+class ClusterIndex {
+private:
+    std::vector<StateCluster> clusters;
+    std::vector<int> slots;
+
+    void grow();
+
+public:
+    ClusterIndex() : slots(16, -1) {}
+
+    // Returns the index of `cluster` and whether it was newly added.
+    std::pair<int, bool> insert(const StateCluster& cluster);
+
+    [[nodiscard]] int find(const StateCluster& cluster) const;
+
+    void clear() {
+        clusters.clear();
+        slots.assign(16, -1);
+    }
+
+    [[nodiscard]] const StateCluster& operator[](const int index) const {
+        return clusters[index];
+    }
+
+    [[nodiscard]] int size() const {
+        return static_cast<int>(clusters.size());
+    }
+};
+
+// Hash set of clusters split into independently locked shards, used to deduplicate
+// clusters produced concurrently. Entries never move, so returned pointers stay valid
+// until clear(); the mapped int is free for the caller (initially -1).
+class ConcurrentClusterSet {
+private:
+    struct Shard {
+        std::mutex lock;
+        std::unordered_map<StateCluster, int, StateClusterHash> entries;
+    };
+
+    std::vector<Shard> shards;
+
+public:
+    explicit ConcurrentClusterSet(const size_t shardCount = 64) : shards(shardCount) {}
+
+    std::pair<const StateCluster, int>* insert(StateCluster cluster) {
+        Shard& shard = shards[(cluster.hash() >> 32) % shards.size()];
+        std::lock_guard guard(shard.lock);
+        return &*shard.entries.try_emplace(std::move(cluster), -1).first;
     }
 
-    [[nodiscard]] StateCluster stepWith(char symbol, const std::vector<std::shared_ptr<StateNode>>& id_map) const;
-};
\ No newline at end of file
+    void clear() {
+        for (auto& shard : shards) {
+            shard.entries.clear();
+        }
+    }
+};
@@ -0,0 +1,291 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+
+#include "RegexSyntax.h"
+
+// Compile-time counterpart of PostfixConverter -> RegToken -> FiniteAutomaton::determinize for
+// patterns known at build time. The same infix rules, Thompson construction and subset
+// construction run in a constant-evaluated context and leave a static constexpr DFA table:
+//
+//     using Identifier = StaticRegex<"(a|b)(a|b|0|1)*">;
+//     static_assert(Identifier::match("ab01"));
+//     if (Identifier::match(input)) { ... }
+//
+// Errors (malformed pattern, more than MaxStates DFA states) are reported as compile errors.
+namespace StaticRegexDetail {
+    template<size_t N>
+    struct FixedString {
+        char data[N]{};
+
+        constexpr FixedString(const char (&text)[N]) {
+            for (size_t i = 0; i < N; ++i) data[i] = text[i];
+        }
+
+        [[nodiscard]] constexpr size_t size() const { return N - 1; }
+    };
+
+    template<typename T, size_t Capacity>
+    struct FixedStack {
+        std::array<T, Capacity> items{};
+        size_t size = 0;
+
+        constexpr void push(const T &item) {
+            if (size == Capacity) throw std::length_error("StaticRegex: capacity exceeded");
+            items[size++] = item;
+        }
+
+        constexpr T pop() {
+            if (size == 0) throw std::invalid_argument("StaticRegex: postfix expression is wrong");
+            return items[--size];
+        }
+
+        [[nodiscard]] constexpr const T &top() const { return items[size - 1]; }
+        [[nodiscard]] constexpr bool empty() const { return size == 0; }
+    };
+
+    // PostfixConverter::getPostfix: explicit '.' insertion, then Shunting Yard.
+    template<FixedString Pattern>
+    constexpr auto toPostfix() {
+        constexpr size_t n = Pattern.size();
+        static_assert(n > 0, "StaticRegex: empty pattern");
+
+        FixedStack<char, 2 * n> infix;
+        for (size_t i = 0; i + 1 < n; ++i) {
+            infix.push(Pattern.data[i]);
+            if (RegexSyntax::concatenates(Pattern.data[i], Pattern.data[i + 1])) {
+                infix.push('.');
+            }
+        }
+        infix.push(Pattern.data[n - 1]);
+
+        FixedStack<char, 2 * n> postfix;
+        FixedStack<char, 2 * n> operators;
+        RegexSyntax::toPostfix(std::string_view(infix.items.data(), infix.size), operators,
+                               [&](const char c) { postfix.push(c); });
+
+        return postfix;
+    }
+
+    template<size_t Words>
+    struct NodeSet {
+        std::array<uint64_t, Words> bits{};
+
+        constexpr void insert(const size_t node) { bits[node / 64] |= uint64_t{1} << (node % 64); }
+        [[nodiscard]] constexpr bool contains(const size_t node) const { return (bits[node / 64] >> (node % 64)) & 1; }
+
+        constexpr void unionWith(const NodeSet &other) {
+            for (size_t i = 0; i < Words; ++i) bits[i] |= other.bits[i];
+        }
+
+        [[nodiscard]] constexpr bool isEmpty() const {
+            for (const uint64_t word: bits) if (word) return false;
+            return true;
+        }
+
+        constexpr bool operator==(const NodeSet &) const = default;
+    };
+
+    // Subset-construction result at full capacity; compacted by StaticRegex once its size is known.
+    template<size_t MaxStates, size_t MaxClasses>
+    struct RawDFA {
+        std::array<uint8_t, 256> classMap{};
+        std::array<std::array<uint16_t, MaxClasses>, MaxStates> transitions{};
+        std::array<bool, MaxStates> accepting{};
+        size_t stateCount = 0;
+        size_t classCount = 1;
+    };
+
+    template<FixedString Pattern, size_t MaxStates>
+    constexpr auto determinize() {
+        constexpr auto postfix = toPostfix<Pattern>();
+        constexpr size_t maxNodes = 2 * postfix.size;
+        constexpr size_t maxEdges = 4 * postfix.size;
+        constexpr size_t words = (maxNodes + 63) / 64;
+        constexpr size_t maxClasses = Pattern.size() + 1;
+        constexpr uint16_t unset = 0xffff;
+
+        struct Edge {
+            size_t from = 0, to = 0;
+            char symbol = '\0';
+        };
+        struct Token {
+            size_t start = 0, end = 0;
+        };
+
+        // RegToken::getENFAToken, with '\0' as the epsilon symbol.
+        std::array<Edge, maxEdges> edges{};
+        size_t edgeCount = 0, nodeCount = 0;
+        auto connect = [&](const size_t from, const size_t to, const char symbol = '\0') {
+            edges[edgeCount++] = Edge{from, to, symbol};
+        };
+
+        FixedStack<Token, maxNodes> tokens;
+        for (size_t i = 0; i < postfix.size; ++i) {
+            const char c = postfix.items[i];
+            if (!RegexSyntax::isOperator(c)) {
+                const Token token{nodeCount, nodeCount + 1};
+                nodeCount += 2;
+                connect(token.start, token.end, c);
+                tokens.push(token);
+                continue;
+            }
+
+            Token rhs{};
+            if (RegexSyntax::isBinary(c)) rhs = tokens.pop();
+            const Token lhs = tokens.pop();
+            Token result{};
+
+            if (c == '.') {
+                connect(lhs.end, rhs.start);
+                result = Token{lhs.start, rhs.end};
+            } else if (c == '+') {
+                connect(lhs.end, lhs.start);
+                result = lhs;
+            } else {
+                result = Token{nodeCount, nodeCount + 1};
+                nodeCount += 2;
+                connect(result.start, lhs.start);
+                connect(lhs.end, result.end);
+                if (c == '|') {
+                    connect(result.start, rhs.start);
+                    connect(rhs.end, result.end);
+                } else {
+                    connect(result.start, result.end);
+                    if (c == '*') connect(lhs.end, lhs.start);
+                }
+            }
+            tokens.push(result);
+        }
+        if (tokens.size != 1) throw std::invalid_argument("StaticRegex: postfix expression is wrong");
+        const Token nfa = tokens.top();
+
+        // Epsilon closure of every node (FiniteAutomaton::LambdaScope).
+        std::array<NodeSet<words>, maxNodes> closures{};
+        for (size_t node = 0; node < nodeCount; ++node) {
+            FixedStack<size_t, maxNodes> pending;
+            closures[node].insert(node);
+            pending.push(node);
+            while (!pending.empty()) {
+                const size_t current = pending.pop();
+                for (size_t e = 0; e < edgeCount; ++e) {
+                    if (edges[e].from == current && edges[e].symbol == '\0' && !closures[node].contains(edges[e].to)) {
+                        closures[node].insert(edges[e].to);
+                        pending.push(edges[e].to);
+                    }
+                }
+            }
+        }
+
+        RawDFA<MaxStates, maxClasses> dfa;
+        std::array<char, maxClasses> classSymbol{};
+        for (size_t e = 0; e < edgeCount; ++e) {
+            const auto byte = static_cast<unsigned char>(edges[e].symbol);
+            if (edges[e].symbol != '\0' && dfa.classMap[byte] == 0) {
+                classSymbol[dfa.classCount] = edges[e].symbol;
+                dfa.classMap[byte] = static_cast<uint8_t>(dfa.classCount++);
+            }
+        }
+
+        // Breadth-first subset construction; state 0 is the start closure.
+        std::array<NodeSet<words>, MaxStates> states{};
+        states[0] = closures[nfa.start];
+        dfa.stateCount = 1;
+
+        for (size_t state = 0; state < dfa.stateCount; ++state) {
+            dfa.accepting[state] = states[state].contains(nfa.end);
+            dfa.transitions[state][0] = unset;
+
+            for (size_t cls = 1; cls < dfa.classCount; ++cls) {
+                NodeSet<words> target{};
+                for (size_t e = 0; e < edgeCount; ++e) {
+                    if (edges[e].symbol == classSymbol[cls] && states[state].contains(edges[e].from)) {
+                        target.unionWith(closures[edges[e].to]);
+                    }
+                }
+
+                if (target.isEmpty()) {
+                    dfa.transitions[state][cls] = unset;
+                    continue;
+                }
+
+                size_t index = 0;
+                while (index < dfa.stateCount && !(states[index] == target)) ++index;
+                if (index == dfa.stateCount) {
+                    if (dfa.stateCount == MaxStates) {
+                        throw std::length_error("StaticRegex: more DFA states than MaxStates");
+                    }
+                    states[dfa.stateCount++] = target;
+                }
+                dfa.transitions[state][cls] = static_cast<uint16_t>(index);
+            }
+        }
+
+        return dfa;
+    }
+
+    // Flat stateCount x classCount table plus a dead row (index States) that every missing
+    // transition points to, like CompiledDFA.
+    template<size_t States, size_t Classes>
+    struct StaticDFA {
+        std::array<uint8_t, 256> classMap{};
+        std::array<uint16_t, (States + 1) * Classes> table{};
+        std::array<bool, States + 1> accepting{};
+    };
+
+    template<size_t States, size_t Classes, typename Raw>
+    constexpr StaticDFA<States, Classes> compact(const Raw &raw) {
+        StaticDFA<States, Classes> dfa;
+        dfa.classMap = raw.classMap;
+        for (size_t state = 0; state <= States; ++state) {
+            for (size_t cls = 0; cls < Classes; ++cls) {
+                const uint16_t target = state < States ? raw.transitions[state][cls] : 0xffff;
+                dfa.table[state * Classes + cls] = target == 0xffff ? static_cast<uint16_t>(States) : target;
+            }
+            dfa.accepting[state] = state < States && raw.accepting[state];
+        }
+        return dfa;
+    }
+}
+
+template<StaticRegexDetail::FixedString Pattern, size_t MaxStates = 256>
+class StaticRegex {
+    static_assert(MaxStates < 0xffff, "StaticRegex: state ids are 16-bit");
+
+    static constexpr auto raw = StaticRegexDetail::determinize<Pattern, MaxStates>();
+
+public:
+    static constexpr size_t stateCount = raw.stateCount;
+    static constexpr size_t classCount = raw.classCount;
+    static constexpr uint16_t deadState = stateCount;
+
+private:
+    static constexpr auto dfa = StaticRegexDetail::compact<stateCount, classCount>(raw);
+
+public:
+    // Whole-word match, usable in constant expressions.
+    [[nodiscard]] static constexpr bool match(const std::string_view word) {
+        uint16_t state = 0;
+        for (const char c: word) {
+            state = dfa.table[state * classCount + dfa.classMap[static_cast<unsigned char>(c)]];
+            if (state == deadState) return false;
+        }
+        return dfa.accepting[state];
+    }
+
+    // Length of the longest accepted prefix of text, or std::string_view::npos.
+    [[nodiscard]] static constexpr size_t longestMatch(const std::string_view text) {
+        uint16_t state = 0;
+        size_t longest = dfa.accepting[state] ? 0 : std::string_view::npos;
+        for (size_t i = 0; i < text.size(); ++i) {
+            state = dfa.table[state * classCount + dfa.classMap[static_cast<unsigned char>(text[i])]];
+            if (state == deadState) break;
+            if (dfa.accepting[state]) longest = i + 1;
+        }
+        return longest;
+    }
+};
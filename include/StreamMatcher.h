@@ -0,0 +1,32 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "CompiledDFA.h"
+#include "GlushkovMatcher.h"
+
+// Matches input delivered in chunks against a compiled automaton, keeping only
+// the current state between calls. feed() never allocates.
+class StreamMatcher {
+private:
+    std::shared_ptr<const CompiledDFA> dfa;
+    std::shared_ptr<const GlushkovMatcher> bitParallel;
+    uint64_t state = 0;
+
+public:
+    explicit StreamMatcher(std::shared_ptr<const CompiledDFA> dfa);
+
+    explicit StreamMatcher(std::shared_ptr<const GlushkovMatcher> bitParallel);
+
+    void feed(std::string_view chunk);
+
+    // Feeds the whole content of a file, memory-mapped where the platform allows it.
+    void feedFile(const std::string &path);
+
+    // Returns whether everything fed since the last reset is accepted, then resets.
+    [[nodiscard]] bool finish();
+
+    void reset();
+};
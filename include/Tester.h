@@ -13,12 +13,25 @@ namespace fs = std::filesystem;
 class Tester {
     std::string testDirectory = "../tests";
     std::unordered_map<std::string, Test> tests;
+    // Entry number of each test over the files in name order; run() prints in this order,
+    // the same as stream(). A repeated name keeps its last entry.
+    std::unordered_map<std::string, size_t> positions;
+    size_t entriesRead = 0;
+    // Also print the NFA trace and the state map of every compiled test.
+    bool verbose = false;
 
     void makeTests(const std::string &filename);
 
+    static std::string runTest(const std::string &name, const Test &test, bool verbose);
+
     Tester() = default;
 
 public:
+    // Tests that stream() has parsed but not printed yet; bounds its memory.
+    static constexpr size_t streamWindow = 256;
+    // Test files that stream() parses at the same time.
+    static constexpr size_t streamReaders = 4;
+
     static Tester &getInstance() {
         static Tester instance;
         return instance;
@@ -30,9 +43,23 @@ public:
 
     std::string getTestDirectory();
 
+    void setTestDirectory(std::string directory) {
+        testDirectory = std::move(directory);
+    }
+
+    void setVerbose(const bool value) {
+        verbose = value;
+    }
+
     void clearTests();
 
     void init();
 
     void run();
+
+    // Runs the tests of every file in testDirectory without init(): entries are parsed one at a
+    // time through the SAX interface and compiled on the pool while the rest of the file is
+    // read. No DOM or test map is built. Output is printed in file order, then entry order,
+    // as run() prints it.
+    void stream();
 };
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size pool with one task deque per worker. Workers pop their own deque from
+// the back and steal from the front of the others' when it runs dry.
+class ThreadPool {
+private:
+    struct WorkQueue {
+        std::deque<std::function<void()>> tasks;
+        std::mutex lock;
+    };
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex wakeLock;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    std::atomic<size_t> queued = 0;
+    std::atomic<size_t> pending = 0;
+    std::atomic<size_t> nextQueue = 0;
+    bool stopping = false;
+    // First exception thrown by a task since the last wait(); guarded by wakeLock.
+    std::exception_ptr failure;
+
+    bool tryPop(size_t index, std::function<void()> &task);
+
+    void workerLoop(size_t index);
+
+public:
+    explicit ThreadPool(size_t threads = std::thread::hardware_concurrency());
+
+    ThreadPool(const ThreadPool &) = delete;
+
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    ~ThreadPool();
+
+    void submit(std::function<void()> task);
+
+    // Blocks until every submitted task has finished. A task that throws does not stop its
+    // worker: the first exception is kept and rethrown here, once the other tasks are done.
+    void wait();
+
+    [[nodiscard]] size_t size() const {
+        return workers.size();
+    }
+};
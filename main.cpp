@@ -1,9 +1,23 @@
+#include <cstring>
+
 #include "Tester.h"
 
 using namespace std;
-int main() {
+int main(const int argc, char **argv) {
 
     Tester &app = Tester::getInstance();
-    app.init();
-    app.run();
+    bool streaming = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--verbose") == 0 || std::strcmp(argv[i], "-v") == 0) {
+            app.setVerbose(true);
+        } else if (std::strcmp(argv[i], "--stream") == 0) {
+            streaming = true;
+        }
+    }
+    if (streaming) {
+        app.stream();
+    } else {
+        app.init();
+        app.run();
+    }
 }
\ No newline at end of file
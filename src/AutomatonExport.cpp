@@ -0,0 +1,89 @@
+#include <format>
+#include <map>
+
+#include "AutomatonExport.h"
+
+static std::string escapeJson(const std::string &text) {
+    std::string result;
+    for (const char c: text) {
+        const auto byte = static_cast<unsigned char>(c);
+        if (c == '"' || c == '\\') {
+            result += '\\';
+            result += c;
+        } else if (byte < 0x20 || byte >= 0x7f) {
+            result += std::format("\\u{:04x}", static_cast<int>(byte));
+        } else {
+            result += c;
+        }
+    }
+    return result;
+}
+
+static std::string escapeDot(const char c) {
+    const auto byte = static_cast<unsigned char>(c);
+    if (c == '"' || c == '\\') return std::string("\\") + c;
+    if (byte < 0x20 || byte >= 0x7f) return std::format("\\\\x{:02x}", static_cast<int>(byte));
+    return std::string(1, c);
+}
+
+static void writeDot(std::ostream &os, const std::string &kind, const std::vector<std::string> &names,
+                     const int start, const std::vector<bool> &accepting, const std::vector<ExportEdge> &edges) {
+    os << "digraph " << kind << " {\n";
+    os << "    rankdir=LR;\n";
+    os << "    node [shape=circle];\n";
+    os << "    __start [shape=point];\n";
+    if (start >= 0) {
+        os << "    __start -> s" << start << ";\n";
+    }
+
+    for (size_t i = 0; i < names.size(); ++i) {
+        os << std::format("    s{} [label=\"", i);
+        for (const char c: names[i]) os << escapeDot(c);
+        os << (accepting[i] ? "\", shape=doublecircle];\n" : "\"];\n");
+    }
+
+    std::map<std::pair<int, int>, std::string> labels;
+    for (const auto &[from, to, symbol]: edges) {
+        std::string &label = labels[{from, to}];
+        if (!label.empty()) label += ",";
+        label += symbol == '\0' ? "&epsilon;" : escapeDot(symbol);
+    }
+    for (const auto &[endpoints, label]: labels) {
+        os << std::format("    s{} -> s{} [label=\"{}\"];\n", endpoints.first, endpoints.second, label);
+    }
+
+    os << "}\n";
+}
+
+static void writeJson(std::ostream &os, const std::string &kind, const std::vector<std::string> &names,
+                      const int start, const std::vector<bool> &accepting, const std::vector<ExportEdge> &edges) {
+    os << std::format("{{\"kind\":\"{}\",\"start\":{},\"states\":[", escapeJson(kind), start);
+    for (size_t i = 0; i < names.size(); ++i) {
+        if (i) os << ",";
+        os << std::format("{{\"id\":{},\"name\":\"{}\",\"accepting\":{}}}", i, escapeJson(names[i]),
+                          accepting[i] ? "true" : "false");
+    }
+
+    os << "],\"transitions\":[";
+    for (size_t i = 0; i < edges.size(); ++i) {
+        if (i) os << ",";
+        const auto &[from, to, symbol] = edges[i];
+        os << std::format("{{\"from\":{},\"to\":{},\"symbol\":", from, to);
+        if (symbol == '\0') {
+            os << "null}";
+        } else {
+            os << "\"" << escapeJson(std::string(1, symbol)) << "\"}";
+        }
+    }
+    os << "]}\n";
+}
+
+void writeAutomaton(std::ostream &os, const ExportFormat format, const std::string &kind,
+                    const std::vector<std::string> &names, const int start, const std::vector<bool> &accepting,
+                    const std::vector<ExportEdge> &edges) {
+    if (format == ExportFormat::Dot) {
+        writeDot(os, kind, names, start, accepting, edges);
+    } else {
+        writeJson(os, kind, names, start, accepting, edges);
+    }
+}
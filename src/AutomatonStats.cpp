@@ -0,0 +1,20 @@
+#include <format>
+
+#include "AutomatonStats.h"
+
+std::string CompileStats::toJson() const {
+    return std::format(
+        "{{\"engine\":\"{}\",\"stagesMs\":{{\"literals\":{},\"glushkov\":{},\"thompson\":{},\"lambdaScope\":{},"
+        "\"expansion\":{},\"subset\":{},\"table\":{},\"minimize\":{},\"total\":{}}},"
+        "\"nfaNodes\":{},\"nfaEdges\":{},\"closureTotal\":{},\"closureMax\":{},\"dfaStates\":{},"
+        "\"expansionTableBytes\":{},\"tableBytes\":{},\"peakBytes\":{}}}",
+        engine, literalsMs, glushkovMs, thompsonMs, lambdaScopeMs, expansionMs, subsetMs, tableMs, minimizeMs,
+        totalMs, nfaNodes, nfaEdges, closureTotal, closureMax, dfaStates, expansionTableBytes, tableBytes,
+        peakBytes);
+}
+
+std::string MatchStats::toJson() const {
+    return std::format(
+        "{{\"calls\":{},\"accepted\":{},\"bytesProcessed\":{},\"transitions\":{},\"totalMs\":{}}}",
+        calls, accepted, bytesProcessed, transitions, totalMs);
+}
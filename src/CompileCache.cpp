@@ -0,0 +1,165 @@
+#include <algorithm>
+#include <format>
+#include <functional>
+
+#include "CompileCache.h"
+#include "RegexSyntax.h"
+
+CompileCache::CompileCache(const size_t maxEntries, const size_t maxBytes, const size_t shardCount)
+    : shards(std::max<size_t>(shardCount, 1)),
+      entriesPerShard(std::max<size_t>((maxEntries + shards.size() - 1) / shards.size(), 1)),
+      bytesPerShard(std::max<size_t>(maxBytes / shards.size(), 1)) {
+}
+
+std::string CompileCache::makeKey(const std::string &postfix, const CompileOptions &options) {
+    // threads and log do not change the automaton, so they are not part of the key.
+    return std::format("{}\x1f{}{}{}", normalize(postfix), static_cast<int>(options.engine),
+                       options.minimize ? 'm' : '-', options.lazyCacheBytes);
+}
+
+CompileCache::Shard &CompileCache::shardFor(const std::string &key) {
+    return shards[std::hash<std::string>{}(key) % shards.size()];
+}
+
+void CompileCache::evict(Shard &shard) {
+    while (shard.order.size() > 1 && (shard.order.size() > entriesPerShard || shard.bytes > bytesPerShard)) {
+        const Entry &victim = shard.order.back();
+        shard.bytes -= victim.bytes;
+        shard.index.erase(victim.key);
+        shard.order.pop_back();
+    }
+}
+
+CompileCache::Handle CompileCache::get(const std::string &postfix, const CompileOptions &options) {
+    std::string key = makeKey(postfix, options);
+    Shard &shard = shardFor(key);
+
+    {
+        std::lock_guard guard(shard.lock);
+        if (const auto it = shard.index.find(key); it != shard.index.end()) {
+            shard.order.splice(shard.order.begin(), shard.order, it->second);
+            ++hits;
+            return it->second->automaton;
+        }
+    }
+
+    ++misses;
+    Handle automaton(FiniteAutomaton::buildFromRegex(postfix, options));
+    const size_t bytes = automaton->getMemoryFootprint() + key.capacity();
+
+    std::lock_guard guard(shard.lock);
+    if (const auto it = shard.index.find(key); it != shard.index.end()) {
+        // Another thread compiled the same pattern meanwhile; share its copy.
+        shard.order.splice(shard.order.begin(), shard.order, it->second);
+        return it->second->automaton;
+    }
+    if (bytes > bytesPerShard) {
+        return automaton;
+    }
+
+    shard.order.push_front(Entry{key, automaton, bytes});
+    shard.index.emplace(std::move(key), shard.order.begin());
+    shard.bytes += bytes;
+    evict(shard);
+
+    return automaton;
+}
+
+std::string CompileCache::normalize(const std::string &postfix) {
+    struct Node {
+        char op;
+        std::vector<int> children;
+    };
+
+    using RegexSyntax::isBinary;
+    using RegexSyntax::isUnary;
+
+    std::vector<Node> nodes;
+    std::vector<int> stack;
+
+    for (const char c: postfix) {
+        if (isBinary(c)) {
+            if (stack.size() < 2) return postfix;
+            const int rhs = stack.back();
+            stack.pop_back();
+            const int lhs = stack.back();
+            stack.pop_back();
+
+            Node node{c, {}};
+            for (const int child: {lhs, rhs}) {
+                if (nodes[child].op == c) {
+                    node.children.insert(node.children.end(), nodes[child].children.begin(),
+                                         nodes[child].children.end());
+                } else {
+                    node.children.push_back(child);
+                }
+            }
+            nodes.push_back(std::move(node));
+            stack.push_back(static_cast<int>(nodes.size()) - 1);
+        } else if (isUnary(c)) {
+            if (stack.empty()) return postfix;
+            int operand = stack.back();
+            char op = c;
+            if (isUnary(nodes[operand].op)) {
+                // x** = x*, x++ = x+, x?? = x?; any other pair of the three is x*.
+                if (nodes[operand].op != c) op = '*';
+                operand = nodes[operand].children[0];
+            }
+            nodes.push_back(Node{op, {operand}});
+            stack.back() = static_cast<int>(nodes.size()) - 1;
+        } else {
+            nodes.push_back(Node{c, {}});
+            stack.push_back(static_cast<int>(nodes.size()) - 1);
+        }
+    }
+
+    if (stack.size() != 1) return postfix;
+
+    std::string result;
+    result.reserve(postfix.size());
+    std::function<void(int)> emit = [&](const int index) {
+        const Node &node = nodes[index];
+        if (node.children.empty()) {
+            result += node.op;
+        } else if (isUnary(node.op)) {
+            emit(node.children[0]);
+            result += node.op;
+        } else {
+            emit(node.children[0]);
+            for (size_t i = 1; i < node.children.size(); ++i) {
+                emit(node.children[i]);
+                result += node.op;
+            }
+        }
+    };
+    emit(stack.back());
+
+    return result;
+}
+
+void CompileCache::clear() {
+    for (auto &shard: shards) {
+        std::lock_guard guard(shard.lock);
+        shard.index.clear();
+        shard.order.clear();
+        shard.bytes = 0;
+    }
+}
+
+size_t CompileCache::size() {
+    size_t total = 0;
+    for (auto &shard: shards) {
+        std::lock_guard guard(shard.lock);
+        total += shard.order.size();
+    }
+    return total;
+}
+
+size_t CompileCache::getBytes() {
+    size_t total = 0;
+    for (auto &shard: shards) {
+        std::lock_guard guard(shard.lock);
+        total += shard.bytes;
+    }
+    return total;
+}
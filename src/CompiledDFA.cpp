@@ -0,0 +1,292 @@
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "CompiledDFA.h"
+#include "InterleavedMatch.h"
+
+static_assert(sizeof(CompiledDFA::FileHeader) == 64);
+
+namespace {
+    constexpr uint64_t classMapOffset = sizeof(CompiledDFA::FileHeader);
+
+    uint64_t alignTo64(const uint64_t offset) {
+        return (offset + 63) & ~uint64_t{63};
+    }
+}
+
+CompiledDFA::CompiledDFA(const uint32_t liveStates, const uint32_t start)
+    : stateCount(liveStates + 1), startState(start), deadState(liveStates) {
+    table.assign(static_cast<size_t>(stateCount) * alphabetSize, deadState);
+    acceptBits.assign((stateCount + 63) / 64, 0);
+    for (uint32_t symbol = 0; symbol < alphabetSize; ++symbol) {
+        classMap[symbol] = static_cast<uint8_t>(symbol);
+    }
+    bindOwnedStorage();
+}
+
+CompiledDFA::CompiledDFA(const uint32_t liveStates, const uint32_t start, const std::array<uint8_t, 256> &byteClasses,
+                         const uint32_t classes)
+    : classMap(byteClasses), classCount(classes), stateCount(liveStates + 1), startState(start),
+      deadState(liveStates) {
+    table.assign(static_cast<size_t>(stateCount) * classCount, deadState);
+    acceptBits.assign((stateCount + 63) / 64, 0);
+    bindOwnedStorage();
+}
+
+void CompiledDFA::bindOwnedStorage() {
+    rows = table.data();
+    accept = acceptBits.data();
+    classes = classMap.data();
+}
+
+void CompiledDFA::compressAlphabet() {
+    std::map<std::vector<uint32_t>, uint8_t> classes;
+    std::vector<uint32_t> representative;
+    std::vector<uint32_t> column(stateCount);
+
+    for (uint32_t symbol = 0; symbol < alphabetSize; ++symbol) {
+        for (uint32_t state = 0; state < stateCount; ++state) {
+            column[state] = table[state * classCount + classMap[symbol]];
+        }
+
+        auto [it, inserted] = classes.try_emplace(column, static_cast<uint8_t>(classes.size()));
+        if (inserted) {
+            representative.push_back(classMap[symbol]);
+        }
+        classMap[symbol] = it->second;
+    }
+
+    const auto compressedCount = static_cast<uint32_t>(representative.size());
+    std::vector<uint32_t> compressed(static_cast<size_t>(stateCount) * compressedCount);
+    for (uint32_t state = 0; state < stateCount; ++state) {
+        for (uint32_t cls = 0; cls < compressedCount; ++cls) {
+            compressed[state * compressedCount + cls] = table[state * classCount + representative[cls]];
+        }
+    }
+
+    table = std::move(compressed);
+    classCount = compressedCount;
+    bindOwnedStorage();
+}
+
+size_t CompiledDFA::longestMatch(const std::string_view text) const {
+    uint32_t state = startState;
+    size_t longest = isAccepting(state) ? 0 : std::string_view::npos;
+
+    for (size_t i = 0; i < text.size(); ++i) {
+        state = next(state, static_cast<unsigned char>(text[i]));
+        if (state == deadState) {
+            break;
+        }
+        if (isAccepting(state)) {
+            longest = i + 1;
+        }
+    }
+
+    return longest;
+}
+
+uint32_t CompiledDFA::finalState(const std::string_view word) const {
+    uint32_t state = startState;
+
+    for (const unsigned char symbol : word) {
+        state = next(state, symbol);
+        if (state == deadState) {
+            break;
+        }
+    }
+
+    return state;
+}
+
+bool CompiledDFA::process(const std::string_view word) const {
+    const uint32_t *base = rows;
+    const uint8_t *map = classes;
+    const uint32_t stride = classCount;
+    uint32_t state = startState;
+
+    for (const unsigned char symbol : word) {
+        state = base[state * stride + map[symbol]];
+        if (state == deadState) {
+            return false;
+        }
+    }
+
+    return isAccepting(state);
+}
+
+void CompiledDFA::processMany(const std::span<const std::string_view> words, uint64_t *bits) const {
+    const uint32_t *base = rows;
+    const uint8_t *map = classes;
+    const uint32_t stride = classCount;
+    const size_t tableBytes = static_cast<size_t>(stateCount) * classCount * sizeof(uint32_t);
+
+    interleavedMatch(words, bits, startState, deadState,
+                     [=](const uint32_t state, const unsigned char symbol) {
+                         return base[state * stride + map[symbol]];
+                     },
+                     [this](const uint32_t state) { return isAccepting(state); },
+                     tableBytes <= InterleavedMatchDetail::cacheResidentBytes
+                         ? SIZE_MAX
+                         : InterleavedMatchDetail::defaultMinLaneLength);
+}
+
+void CompiledDFA::save(std::ostream &os) const {
+    const uint64_t tableBytes = static_cast<uint64_t>(stateCount) * classCount * sizeof(uint32_t);
+    const uint64_t acceptBytes = static_cast<uint64_t>((stateCount + 63) / 64) * sizeof(uint64_t);
+
+    FileHeader header{};
+    std::memcpy(header.magic, fileMagic, sizeof(fileMagic));
+    header.version = fileVersion;
+    header.byteOrder = fileByteOrder;
+    header.stateCount = stateCount;
+    header.classCount = classCount;
+    header.startState = startState;
+    header.deadState = deadState;
+    header.tableOffset = alignTo64(classMapOffset + alphabetSize);
+    header.acceptOffset = alignTo64(header.tableOffset + tableBytes);
+    header.fileSize = header.acceptOffset + acceptBytes;
+
+    const char padding[64] = {};
+    auto pad = [&](const uint64_t written, const uint64_t target) {
+        os.write(padding, static_cast<std::streamsize>(target - written));
+    };
+
+    os.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    os.write(reinterpret_cast<const char *>(classes), alphabetSize);
+    pad(classMapOffset + alphabetSize, header.tableOffset);
+    os.write(reinterpret_cast<const char *>(rows), static_cast<std::streamsize>(tableBytes));
+    pad(header.tableOffset + tableBytes, header.acceptOffset);
+    os.write(reinterpret_cast<const char *>(accept), static_cast<std::streamsize>(acceptBytes));
+
+    if (!os) {
+        throw std::runtime_error("Could not write compiled automaton");
+    }
+}
+
+void CompiledDFA::save(const std::string &path) const {
+    std::ofstream f(path, std::ios::binary | std::ios::trunc);
+    if (!f.is_open()) {
+        throw std::runtime_error("Could not open file for writing: " + path);
+    }
+    save(f);
+}
+
+#ifdef _WIN32
+// No mmap: the image is read into one heap block, then used exactly like a mapping.
+static std::shared_ptr<const void> mapImage(const std::string &path, size_t &size) {
+    std::ifstream f(path, std::ios::binary | std::ios::ate);
+    if (!f.is_open()) {
+        throw std::runtime_error("Provided file does not exist: " + path);
+    }
+
+    size = static_cast<size_t>(f.tellg());
+    std::shared_ptr<uint64_t[]> block(new uint64_t[(size + 7) / 8]);
+    f.seekg(0);
+    f.read(reinterpret_cast<char *>(block.get()), static_cast<std::streamsize>(size));
+    return std::shared_ptr<const void>(block, block.get());
+}
+#else
+static std::shared_ptr<const void> mapImage(const std::string &path, size_t &size) {
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Provided file does not exist: " + path);
+    }
+
+    struct stat info{};
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        throw std::runtime_error("Could not stat file: " + path);
+    }
+
+    size = static_cast<size_t>(info.st_size);
+    if (size < sizeof(CompiledDFA::FileHeader)) {
+        close(fd);
+        throw std::runtime_error("Not a compiled automaton: " + path);
+    }
+
+    void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        throw std::runtime_error("Could not map file: " + path);
+    }
+
+    madvise(data, size, MADV_WILLNEED);
+    return {data, [size](const void *mapped) { munmap(const_cast<void *>(mapped), size); }};
+}
+#endif
+
+std::shared_ptr<const CompiledDFA> CompiledDFA::load(const std::string &path) {
+    size_t size = 0;
+    std::shared_ptr<const void> image = mapImage(path, size);
+    const auto *bytes = static_cast<const uint8_t *>(image.get());
+
+    if (size < sizeof(FileHeader)) {
+        throw std::runtime_error("Not a compiled automaton: " + path);
+    }
+
+    FileHeader header{};
+    std::memcpy(&header, bytes, sizeof(header));
+    if (std::memcmp(header.magic, fileMagic, sizeof(fileMagic)) != 0) {
+        throw std::runtime_error("Not a compiled automaton: " + path);
+    }
+    if (header.version != fileVersion) {
+        throw std::runtime_error("Unsupported compiled automaton version " + std::to_string(header.version)
+                                 + ": " + path);
+    }
+    if (header.byteOrder != fileByteOrder) {
+        throw std::runtime_error("Compiled automaton was written with a different byte order: " + path);
+    }
+
+    if (header.stateCount == 0 || header.classCount == 0 || header.classCount > alphabetSize
+        || header.startState >= header.stateCount || header.deadState >= header.stateCount) {
+        throw std::runtime_error("Corrupt compiled automaton header: " + path);
+    }
+
+    // classCount <= 256 and stateCount < 2^32, so neither size can overflow. Every region is
+    // checked against the mapped size by subtraction, so huge offsets cannot wrap around.
+    const uint64_t tableBytes = static_cast<uint64_t>(header.stateCount) * header.classCount * sizeof(uint32_t);
+    const uint64_t acceptBytes = (static_cast<uint64_t>(header.stateCount) + 63) / 64 * sizeof(uint64_t);
+    if (header.tableOffset % 64 != 0 || header.acceptOffset % 64 != 0
+        || header.tableOffset < classMapOffset + alphabetSize
+        || header.tableOffset > size || tableBytes > size - header.tableOffset
+        || header.acceptOffset < header.tableOffset + tableBytes
+        || header.acceptOffset > size || acceptBytes > size - header.acceptOffset
+        || header.fileSize != header.acceptOffset + acceptBytes) {
+        throw std::runtime_error("Corrupt compiled automaton header: " + path);
+    }
+
+    auto dfa = std::shared_ptr<CompiledDFA>(new CompiledDFA());
+    dfa->stateCount = header.stateCount;
+    dfa->classCount = header.classCount;
+    dfa->startState = header.startState;
+    dfa->deadState = header.deadState;
+    dfa->classes = bytes + classMapOffset;
+    dfa->rows = reinterpret_cast<const uint32_t *>(bytes + header.tableOffset);
+    dfa->accept = reinterpret_cast<const uint64_t *>(bytes + header.acceptOffset);
+
+    // One linear pass so a damaged file can never index outside the table.
+    for (uint32_t symbol = 0; symbol < alphabetSize; ++symbol) {
+        if (dfa->classes[symbol] >= dfa->classCount) {
+            throw std::runtime_error("Corrupt compiled automaton class map: " + path);
+        }
+    }
+    const size_t entries = static_cast<size_t>(dfa->stateCount) * dfa->classCount;
+    for (size_t i = 0; i < entries; ++i) {
+        if (dfa->rows[i] >= dfa->stateCount) {
+            throw std::runtime_error("Corrupt compiled automaton table: " + path);
+        }
+    }
+
+    dfa->image = std::move(image);
+    return dfa;
+}
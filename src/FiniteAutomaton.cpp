@@ -6,25 +6,45 @@
 #include <UserWarn.h>
 #include <Setup.h>
 #include <RegToken.h>
-#include <StateAssembler.h>
+#include <StateCluster.h>
+#include <ThreadPool.h>
+#include <LeftmostSearch.h>
 #include <queue>
 #include <unordered_map>
-#include <map>
 
 FiniteAutomaton::FiniteAutomaton(const std::string &file) {
     const Setup setup(file);
-    setSigma(setup.getSigma());
-    setStates(setup.getStates());
-    setTransitions(setup.getTransitions());
-    setStartState();
+    setDefinition(setup);
+    if (isNondeterministic()) {
+        compileNondeterministic(setup);
+    }
 }
 
 std::ostream &operator<<(std::ostream &os, const FiniteAutomaton &fa) {
-    if (fa.isNondeterministic()) {
-        std::cout << "> NFA" << std::endl;
+    if (fa.lazy) {
+        os << std::format("> Lazy DFA ({} cached states, {} flushes)", fa.lazy->getCachedStates(),
+                          fa.lazy->getFlushCount()) << std::endl;
+    }
+    else if (fa.literal) {
+        os << std::format("> Literal matcher ({} strings)", fa.literal->getLiteralCount()) << std::endl;
+    }
+    else if (fa.bitParallel) {
+        os << std::format("> Bit-parallel Glushkov automaton ({} positions)", fa.bitParallel->getPositionCount())
+           << std::endl;
+    }
+    else if (fa.compiled && fa.states.empty()) {
+        os << std::format("> Loaded DFA ({} states, {} byte classes)", fa.compiled->getStateCount(),
+                          fa.compiled->getClassCount()) << std::endl;
+    }
+    else if (fa.nfa) {
+        os << std::format("> NFA (bitset simulation, {} states)", fa.nfa->getStateCount()) << std::endl;
+    }
+    else if (fa.isNondeterministic()) {
+        os << (fa.compiled ? std::format("> NFA (determinized, {} DFA states)", fa.compiled->getStateCount() - 1)
+                           : std::string("> NFA")) << std::endl;
     }
     else {
-        std::cout << "> DFA" << std::endl;
+        os << "> DFA" << std::endl;
     }
 
     os << "> Sigma: {";
@@ -36,6 +56,12 @@ std::ostream &operator<<(std::ostream &os, const FiniteAutomaton &fa) {
     }
     os << "}\n";
 
+    // The Literal, BitParallel, LazyDFA and loaded-table engines keep no State graph; the
+    // header line above already describes them.
+    if (fa.states.empty()) {
+        return os;
+    }
+
     first = true;
     os << "> States: {";
     for (const auto &state: fa.states) {
@@ -66,16 +92,16 @@ std::ostream &operator<<(std::ostream &os, const FiniteAutomaton &fa) {
 
     os << "> State Map:\n";
     for (const auto& state : fa.states) {
-        std::cout << std::format(">> {}:\n", state->name);
+        os << std::format(">> {}:\n", state->name);
         for (auto letter : fa.sigma) {
             auto [fst, snd] = state->transitions.equal_range(letter);
             if (fst == snd) {
-                std::cout << std::format(">>> [With <{}> - NO_MOVE])\n", letter);
+                os << std::format(">>> [With <{}> - NO_MOVE])\n", letter);
             } else {
-                std::cout << std::format(">>> [With <{}> > To <{}>]\n", fst->first, fst->second->name);
+                os << std::format(">>> [With <{}> > To <{}>]\n", fst->first, fst->second->name);
             }
         }
-        std::cout << std::endl;
+        os << std::endl;
     }
 
     return os;
@@ -85,101 +111,43 @@ bool FiniteAutomaton::inSigma(const char &symbol) const {
     return this->sigma.contains(symbol);
 }
 
-void FiniteAutomaton::setSigma(std::vector<std::string> const &sigma_) {
-    for (const auto &line: sigma_) {
-        this->sigma.insert(line[0]);
-    }
+void FiniteAutomaton::setSigma(const std::unordered_set<char> &sigma) {
+    this->sigma = sigma;
 }
 
-void FiniteAutomaton::setStates(const std::vector<std::string> &stateLines) {
-    bool hasInitialState = false, hasFinalState = false;
-    for (const auto &line: stateLines) {
-        auto newState = std::make_shared<State>();
-
-        std::istringstream iss(line);
-        std::string token;
-
-        while (std::getline(iss, token, ',')) {
-            token.erase(0, token.find_first_not_of(' '));
-            token.erase(token.find_last_not_of(' ') + 1);
-
-            if (token == "S") {
-                if (hasInitialState) {
-                    UserWarn("Initial state should be unique", line);
-                }
-                hasInitialState = true;
-                newState->initial = true;
-            } else if (token == "F") {
-                newState->final = true;
-                hasFinalState = true;
-            } else {
-                newState->name = token;
-            }
-        }
-
-        if (newState->name.empty()) {
-            UserWarn("State must have a name", line);
-            continue;
-        }
+void FiniteAutomaton::setDefinition(const Setup &setup) {
+    sigma.insert(setup.getSigma().begin(), setup.getSigma().end());
 
-        this->stateMap[newState->name] = newState;
-        this->states.push_back(newState);
-    }
-
-    if (this->states.empty()) {
-        UserWarn("There are no states declared for this DFA");
+    const auto &names = setup.getStates();
+    states.reserve(names.size());
+    stateMap.reserve(names.size());
+    for (size_t id = 0; id < names.size(); ++id) {
+        auto state = std::make_shared<State>();
+        state->name = names[id];
+        state->final = setup.getFinalStates()[id];
+        state->initial = id == setup.getInitialState();
+        stateMap[state->name] = state;
+        states.push_back(std::move(state));
     }
 
-    if (!hasFinalState) {
-        UserWarn("At least one final state required");
+    for (const auto &[from, to, symbol]: setup.getTransitions()) {
+        states[from]->transitions.insert({symbol, states[to]});
     }
-}
-
-void FiniteAutomaton::setSigma(const std::unordered_set<char> &sigma) {
-    this->sigma = sigma;
-}
-
-void FiniteAutomaton::setTransitions(std::vector<std::string> const &transitions) {
-    for (const auto &line: transitions) {
-        std::istringstream iss(line);
-        std::string fromState, toState, token;
-        char symbol;
-
-        int tokenCount = 0;
-        while (std::getline(iss, token, ',')) {
-            token.erase(0, token.find_first_not_of(' '));
-            token.erase(token.find_last_not_of(' ') + 1);
-            switch (tokenCount++) {
-                case 0: fromState = token;
-                    break;
-                case 1: if (token.length() > 1) UserWarn("The symbol should be an unique character", line);
-                    symbol = token[0];
-                    break;
-                case 2: toState = token;
-                    break;
-                default: break;
-            }
-        }
-
-        if (!inSigma(symbol)) {
-            UserWarn("The symbol is not defined in Sigma");
-        }
 
-        if (this->stateMap.contains(fromState) && this->stateMap.contains(toState)) {
-            this->stateMap[fromState]->transitions.insert({symbol, this->stateMap[toState]});
-        } else {
-            UserWarn("There are undefined states", line);
-        }
+    if (setup.getInitialState() != Setup::noState) {
+        startState = states[setup.getInitialState()];
     }
 }
 
-void FiniteAutomaton::setStartState() {
-    for (const auto &state: states) {
-        if (state->initial) {
-            startState = state;
-            break;
+void FiniteAutomaton::compileNondeterministic(const Setup &setup) {
+    auto simulator = std::make_shared<NFASimulator>(setup);
+    if (setup.getStates().size() <= subsetConstructionStates) {
+        if (auto table = simulator->determinize(maxDeterminizedStates)) {
+            compiled = std::move(table);
+            return;
         }
     }
+    nfa = std::move(simulator);
 }
 
 bool FiniteAutomaton::isNondeterministic() const {
@@ -193,51 +161,114 @@ bool FiniteAutomaton::isNondeterministic() const {
 }
 
 void FiniteAutomaton::DFS(
-    const std::shared_ptr<StateNode> &origin,
-    const std::function<void(std::shared_ptr<StateNode>)> &action,
-    const std::function<bool(const std::pair<std::shared_ptr<StateNode>, std::optional<char> > &)> &validate) {
-    std::unordered_set<int> visited;
-    std::stack<std::shared_ptr<StateNode> > toExplore;
-
-    if (!origin) return;
+    const NFAGraph &graph,
+    const int origin,
+    const std::function<void(int)> &action,
+    const std::function<bool(const StateEdge &)> &validate) {
+    std::vector<bool> visited(graph.size(), false);
+    std::stack<int> toExplore;
+
+    if (origin < 0) return;
     toExplore.push(origin);
 
     while (!toExplore.empty()) {
-        const auto node = toExplore.top();
+        const int node = toExplore.top();
         toExplore.pop();
 
-        if (!node || visited.contains(node->id)) continue;
+        if (visited[node]) continue;
 
-        visited.insert(node->id);
+        visited[node] = true;
         action(node);
 
-        for (const auto &[target, symbol]: node->connections) {
-            if (!target) continue;
-
-            std::optional<char> optSymbol = (symbol == '\0') ? std::nullopt : std::optional<char>(symbol);
-            if (!visited.contains(target->id) && validate({target, optSymbol})) {
-                toExplore.push(target);
+        for (const auto &connection: graph.connections(node)) {
+            if (!visited[connection.target] && validate(connection)) {
+                toExplore.push(connection.target);
             }
         }
     }
 }
 
-std::vector<StateCluster> FiniteAutomaton::LambdaScope(const std::vector<std::shared_ptr<StateNode> > &nodes) {
-    std::vector<StateCluster> cluster_states;
-    cluster_states.reserve(nodes.size());
-
-    for (const auto &node: nodes) {
-        StateAssembler builder;
+// Tarjan's SCC algorithm over the epsilon edges, run iteratively. Components are
+// completed in reverse topological order, so when one is popped every component it
+// reaches already has its closure: the component's closure is its own nodes plus the
+// closures of its epsilon successors. Each node then shares its component's closure.
+std::vector<StateCluster> FiniteAutomaton::LambdaScope(const NFAGraph &graph) {
+    const int node_count = graph.size();
+    std::vector<int> index(node_count, -1);
+    std::vector<int> low(node_count, 0);
+    std::vector<int> component(node_count, -1);
+    std::vector<int> tarjanStack;
+    std::vector<std::pair<int, size_t> > callStack;
+    std::vector<StateCluster> componentClosures;
+    // Last component that already merged a given successor component, to merge each once.
+    std::vector<int> mergedInto;
+    std::vector<int> members;
+    int counter = 0;
+
+    for (int root = 0; root < node_count; ++root) {
+        if (index[root] != -1) continue;
+
+        index[root] = low[root] = counter++;
+        tarjanStack.push_back(root);
+        callStack.emplace_back(root, 0);
+
+        while (!callStack.empty()) {
+            auto &[node, edge] = callStack.back();
+            const auto edges = graph.connections(node);
+
+            if (edge < edges.size()) {
+                const StateEdge &connection = edges[edge++];
+                if (connection.symbol != '\0') continue;
+
+                const int target = connection.target;
+                if (index[target] == -1) {
+                    index[target] = low[target] = counter++;
+                    tarjanStack.push_back(target);
+                    callStack.emplace_back(target, 0);
+                } else if (component[target] == -1) {
+                    low[node] = std::min(low[node], index[target]);
+                }
+                continue;
+            }
 
-        DFS(node,
-            [&](const std::shared_ptr<StateNode> &current) {
-                builder.appendState(current);
-            },
-            [](const std::pair<std::shared_ptr<StateNode>, std::optional<char> > &connection) {
-                return !connection.second.has_value();
-            });
+            const int finished = node;
+            callStack.pop_back();
+            if (!callStack.empty()) {
+                const int parent = callStack.back().first;
+                low[parent] = std::min(low[parent], low[finished]);
+            }
+            if (low[finished] != index[finished]) continue;
+
+            const int id = static_cast<int>(componentClosures.size());
+            StateCluster closure(node_count);
+            members.clear();
+            int member;
+            do {
+                member = tarjanStack.back();
+                tarjanStack.pop_back();
+                component[member] = id;
+                closure.insert(member);
+                members.push_back(member);
+            } while (member != finished);
+
+            mergedInto.push_back(-1);
+            for (const int current: members) {
+                for (const auto &[target, symbol]: graph.connections(current)) {
+                    const int successor = component[target];
+                    if (symbol == '\0' && successor != id && mergedInto[successor] != id) {
+                        mergedInto[successor] = id;
+                        closure.unionWith(componentClosures[successor]);
+                    }
+                }
+            }
+            componentClosures.push_back(std::move(closure));
+        }
+    }
 
-        cluster_states.push_back(builder.build());
+    std::vector<StateCluster> cluster_states;
+    cluster_states.reserve(node_count);
+    for (int node = 0; node < node_count; ++node) {
+        cluster_states.push_back(componentClosures[component[node]]);
     }
 
     return cluster_states;
@@ -256,110 +287,260 @@ std::unordered_set<char> FiniteAutomaton::extractSigmaFromRegex(const std::strin
 }
 
 
-static void showTokenization(const std::shared_ptr<RegToken> &token) {
-    std::unordered_set<int> visited;
-    std::stack<std::pair<std::shared_ptr<StateNode>, int> > toExplore;
+static void showTokenization(const NFAGraph &graph, const RegToken &token, std::ostream &os) {
+    std::vector<bool> visited(graph.size(), false);
+    std::stack<std::pair<int, int> > toExplore;
 
-    toExplore.emplace(token->startNode, 0);
+    toExplore.emplace(token.startNode, 0);
 
     while (!toExplore.empty()) {
         auto [node, indent] = toExplore.top();
         toExplore.pop();
 
-        if (!node || visited.contains(node->id)) continue;
-        visited.insert(node->id);
+        if (visited[node]) continue;
+        visited[node] = true;
 
-        for (const auto &[otherNode, symbol]: node->connections) {
+        for (const auto &[otherNode, symbol]: graph.connections(node)) {
             std::string indentStr(indent, ' ');
-            std::cout << std::format("{} {} - {} > {}",
+            os << std::format("{} {} - {} > {}",
                                      indentStr,
-                                     node->toString(),
+                                     NFAGraph::toString(node),
                                      symbol == '\0' ? 'L' : symbol,
-                                     otherNode->toString()
+                                     NFAGraph::toString(otherNode)
             ) << std::endl;
 
-            if (!visited.contains(otherNode->id)) {
+            if (!visited[otherNode]) {
                 toExplore.emplace(otherNode, indent + 1);
             }
         }
     }
 }
 
-FiniteAutomaton *FiniteAutomaton::buildFromRegex(const std::string &postfix) {
-    auto temp = new FiniteAutomaton();
-    temp->setSigma(extractSigmaFromRegex(postfix));
+// Runs body over [0, count) in chunks on the pool, or inline without one.
+static void parallelFor(ThreadPool *pool, const size_t count, const std::function<void(size_t, size_t)> &body) {
+    constexpr size_t minimumChunk = 16;
+    if (!pool || count < 2 * minimumChunk) {
+        body(0, count);
+        return;
+    }
 
-    int node_count = 0;
-    auto postfix_token = RegToken::getENFAToken(postfix, node_count);
-    std::vector<std::shared_ptr<StateNode> > nodes(node_count);
+    const size_t chunk = std::max(minimumChunk, count / (pool->size() * 4) + 1);
+    for (size_t begin = 0; begin < count; begin += chunk) {
+        pool->submit([&body, begin, end = std::min(count, begin + chunk)] {
+            body(begin, end);
+        });
+    }
+    pool->wait();
+}
 
-    showTokenization(postfix_token);
+DeterminizedNFA FiniteAutomaton::determinize(const NFAGraph &graph, const int startNode,
+                                             const std::vector<char> &sigma_vec, const unsigned threads,
+                                             CompileStats *stats) {
+    const int node_count = graph.size();
+    const size_t k = sigma_vec.size();
+    std::chrono::steady_clock::time_point stageStart{};
+    if (stats) stageStart = std::chrono::steady_clock::now();
+
+    std::unique_ptr<ThreadPool> pool;
+    if (threads != 1) {
+        pool = std::make_unique<ThreadPool>(threads == 0 ? std::thread::hardware_concurrency() : threads);
+    }
 
-    DFS(postfix_token->startNode,
-        [&](const std::shared_ptr<StateNode> &current) {
-            nodes[current->id] = current;
-        },
-        [](const std::pair<std::shared_ptr<StateNode>, std::optional<char> > &) {
-            return true;
-        });
+    std::vector<StateCluster> cluster_states = LambdaScope(graph);
+    if (stats) {
+        stats->lambdaScopeMs += elapsedMillis(stageStart);
+        for (const auto &closure: cluster_states) {
+            const size_t size = closure.count();
+            stats->closureTotal += size;
+            stats->closureMax = std::max(stats->closureMax, size);
+        }
+        stageStart = std::chrono::steady_clock::now();
+    }
 
-    std::vector<StateCluster> cluster_states = LambdaScope(nodes);
     std::vector<std::vector<StateCluster> > expansion_table(
-        node_count, std::vector<StateCluster>(temp->getSigma().size()));
+        node_count, std::vector<StateCluster>(k, StateCluster(node_count)));
 
-    std::vector<char> sigma_vec(temp->getSigma().begin(), temp->getSigma().end());
-    std::sort(sigma_vec.begin(), sigma_vec.end());
+    parallelFor(pool.get(), node_count, [&](const size_t begin, const size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const auto &current = cluster_states[i];
 
-    for (int i = 0; i < node_count; ++i) {
-        const auto &current = cluster_states[i];
+            for (size_t j = 0; j < k; ++j) {
+                StateCluster &result = expansion_table[i][j];
+                current.stepWith(sigma_vec[j], graph).forEach([&](const int id) {
+                    result.unionWith(cluster_states[id]);
+                });
+            }
+        }
+    });
 
-        for (size_t j = 0; j < sigma_vec.size(); ++j) {
-            char symbol = sigma_vec[j];
-            StateCluster step = current.stepWith(symbol, nodes);
-            StateCluster result;
+    if (stats) {
+        stats->expansionMs += elapsedMillis(stageStart);
+        stageStart = std::chrono::steady_clock::now();
+    }
 
-            for (const auto &state: step.getStates()) {
-                result = result.unionize(cluster_states[state->id]);
+    DeterminizedNFA dfa;
+    dfa.sigma = sigma_vec;
+    dfa.clusters.insert(cluster_states[startNode]);
+    dfa.transitions.emplace_back(k, -1);
+
+    // BFS one frontier at a time. The successors of a frontier are computed in
+    // parallel: known clusters are looked up read-only in dfa.clusters, new ones are
+    // deduplicated in a ConcurrentClusterSet. A sequential pass then numbers the new
+    // clusters in (state, symbol) order, which is exactly the serial BFS numbering.
+    constexpr int emptyTarget = -1;
+    constexpr int newTarget = -2;
+    ConcurrentClusterSet discovered;
+    std::vector<int> frontier = {0};
+    std::vector<int> targets;
+    std::vector<std::pair<const StateCluster, int> *> candidates;
+
+    while (!frontier.empty()) {
+        targets.assign(frontier.size() * k, emptyTarget);
+        candidates.assign(frontier.size() * k, nullptr);
+
+        parallelFor(pool.get(), frontier.size(), [&](const size_t begin, const size_t end) {
+            for (size_t f = begin; f < end; ++f) {
+                const StateCluster &current = dfa.clusters[frontier[f]];
+
+                for (size_t i = 0; i < k; ++i) {
+                    StateCluster result(node_count);
+                    current.forEach([&](const int id) {
+                        result.unionWith(expansion_table[id][i]);
+                    });
+
+                    if (result.isEmpty()) continue;
+
+                    if (const int known = dfa.clusters.find(result); known != -1) {
+                        targets[f * k + i] = known;
+                    } else {
+                        targets[f * k + i] = newTarget;
+                        candidates[f * k + i] = discovered.insert(std::move(result));
+                    }
+                }
             }
+        });
 
-            expansion_table[i][j] = result;
+        std::vector<int> next;
+        for (size_t f = 0; f < frontier.size(); ++f) {
+            for (size_t i = 0; i < k; ++i) {
+                int target = targets[f * k + i];
+                if (target == newTarget) {
+                    auto &entry = *candidates[f * k + i];
+                    if (entry.second == -1) {
+                        entry.second = dfa.clusters.insert(entry.first).first;
+                        dfa.transitions.emplace_back(k, -1);
+                        next.push_back(entry.second);
+                    }
+                    target = entry.second;
+                }
+                dfa.transitions[frontier[f]][i] = target;
+            }
         }
+
+        discovered.clear();
+        frontier = std::move(next);
     }
 
-    std::map<StateCluster, int> transition_indices;
-    transition_indices[cluster_states[postfix_token->startNode->id]] = 0;
+    if (stats) {
+        stats->subsetMs += elapsedMillis(stageStart);
+
+        const size_t clusterBytes = StateCluster(node_count).byteSize() + sizeof(StateCluster);
+        const size_t states = dfa.transitions.size();
+        const size_t graphBytes = node_count * sizeof(int) + graph.edgeCount() * sizeof(StateEdge);
+        stats->dfaStates = states;
+        stats->expansionTableBytes = node_count * k * clusterBytes;
+        stats->peakBytes = std::max(stats->peakBytes, graphBytes + node_count * clusterBytes
+                                                      + stats->expansionTableBytes + states * clusterBytes
+                                                      + states * k * sizeof(int));
+    }
 
-    std::vector<std::vector<int> > transition_rules;
-    std::queue<StateCluster> q;
-    q.push(cluster_states[postfix_token->startNode->id]);
+    return dfa;
+}
 
-    while (!q.empty()) {
-        StateCluster current = q.front();
-        q.pop();
+FiniteAutomaton *FiniteAutomaton::buildFromRegex(const std::string &postfix, const CompileOptions &options) {
+    // Owned until returned, so a malformed postfix (getENFAToken throws) does not leak it.
+    std::unique_ptr<FiniteAutomaton> temp(new FiniteAutomaton());
+
+    // Stage timing only happens with options.stats; `mark` adds the time since the previous mark.
+    CompileStats *stats = options.stats;
+    std::chrono::steady_clock::time_point buildStart{};
+    if (stats) buildStart = std::chrono::steady_clock::now();
+    auto stageStart = buildStart;
+    auto mark = [&](double &stage) {
+        if (stats) {
+            stage += elapsedMillis(stageStart);
+            stageStart = std::chrono::steady_clock::now();
+        }
+    };
+    auto finish = [&](FiniteAutomaton *fa, const char *engine) {
+        if (stats) {
+            stats->engine = engine;
+            stats->tableBytes = fa->compiled ? fa->compiled->getMemoryFootprint() : 0;
+            stats->totalMs += elapsedMillis(buildStart);
+        }
+        return fa;
+    };
+
+    // The Literal and BitParallel engines never build the Thompson NFA; with a log it is
+    // built anyway, only to be traced.
+    auto traceThompson = [&] {
+        if (options.log) {
+            NFAGraph traced;
+            const RegToken token = RegToken::getENFAToken(postfix, traced);
+            showTokenization(traced, token, *options.log);
+        }
+    };
 
-        std::vector<int> row(sigma_vec.size(), -1);
-        int current_index = static_cast<int>(transition_rules.size());
-        transition_rules.push_back(row);
+    temp->setSigma(extractSigmaFromRegex(postfix));
+    temp->literals = LiteralExtractor::extract(postfix);
 
-        for (size_t i = 0; i < sigma_vec.size(); ++i) {
-            StateCluster result;
-            for (const auto &state: current.getStates()) {
-                result = result.unionize(expansion_table[state->id][i]);
-            }
+    const bool automatonOnly = options.minimize || options.engine == MatchEngine::DFA
+                               || options.engine == MatchEngine::LazyDFA
+                               || options.engine == MatchEngine::BitParallel;
+    if (!automatonOnly && !temp->literals.language.empty()) {
+        temp->literal = LiteralMatcher::build(temp->literals.language);
+    }
+    if (stats) mark(stats->literalsMs);
+    if (temp->literal) {
+        traceThompson();
+        return finish(temp.release(), "Literal");
+    }
 
-            if (result.isEmpty()) continue;
+    if (options.engine == MatchEngine::BitParallel || (options.engine == MatchEngine::Auto && !options.minimize)) {
+        auto matcher = GlushkovMatcher::build(postfix);
+        if (stats) mark(stats->glushkovMs);
+        if (matcher) {
+            temp->bitParallel = std::move(matcher);
+            traceThompson();
+            return finish(temp.release(), "BitParallel");
+        }
+    }
 
-            if (!transition_indices.contains(result)) {
-                int new_index = static_cast<int>(transition_rules.size() + q.size());
-                transition_indices[result] = new_index;
-                q.push(result);
-            }
+    NFAGraph graph;
+    const RegToken postfix_token = RegToken::getENFAToken(postfix, graph);
+    if (stats) {
+        mark(stats->thompsonMs);
+        stats->nfaNodes = graph.size();
+        stats->nfaEdges = graph.edgeCount();
+    }
+    if (options.log) {
+        showTokenization(graph, postfix_token, *options.log);
+    }
 
-            transition_rules[current_index][i] = transition_indices[result];
-        }
+    if (options.engine == MatchEngine::LazyDFA) {
+        temp->lazy = std::make_shared<LazyDFA>(std::move(graph), postfix_token.startNode, postfix_token.endNode,
+                                               options.lazyCacheBytes);
+        return finish(temp.release(), "LazyDFA");
     }
 
-    std::vector<std::shared_ptr<State>> fa_states(transition_rules.size());
+    std::vector<char> sigma_vec(temp->getSigma().begin(), temp->getSigma().end());
+    std::sort(sigma_vec.begin(), sigma_vec.end());
+
+    if (stats) stageStart = std::chrono::steady_clock::now();
+    const DeterminizedNFA dfa = determinize(graph, postfix_token.startNode, sigma_vec, options.threads, stats);
+    if (stats) stageStart = std::chrono::steady_clock::now();
+
+    std::vector<std::shared_ptr<State>> fa_states(dfa.transitions.size());
     for (size_t i = 0; i < fa_states.size(); ++i) {
         auto state = std::make_shared<State>();
         state->name = "q" + std::to_string(i);
@@ -368,27 +549,263 @@ FiniteAutomaton *FiniteAutomaton::buildFromRegex(const std::string &postfix) {
         fa_states[i] = state;
     }
 
-    for (size_t from = 0; from < transition_rules.size(); ++from) {
+    for (size_t from = 0; from < dfa.transitions.size(); ++from) {
         for (size_t j = 0; j < sigma_vec.size(); ++j) {
-            if (int to = transition_rules[from][j]; to != -1) {
+            if (int to = dfa.transitions[from][j]; to != -1) {
                 fa_states[from]->transitions.emplace(sigma_vec[j], fa_states[to]);
             }
         }
     }
 
-    for (const auto &[cluster, index]: transition_indices) {
-        if (cluster.containsState(postfix_token->endNode)) {
+    for (int index = 0; index < dfa.clusters.size(); ++index) {
+        if (dfa.clusters[index].contains(postfix_token.endNode)) {
             fa_states[index]->final = true;
         }
     }
 
     temp->states = fa_states;
     temp->startState = fa_states[0];
+    temp->compile();
+    if (stats) mark(stats->tableMs);
+
+    if (options.minimize) {
+        FiniteAutomaton *minimized = temp->getMinimizedVersion();
+        if (stats) mark(stats->minimizeMs);
+        return finish(minimized, "DFA");
+    }
+
+    return finish(temp.release(), "DFA");
+}
+
+void FiniteAutomaton::compile() {
+    if (!startState || isNondeterministic()) {
+        compiled = nullptr;
+        return;
+    }
+
+    std::unordered_map<const State *, uint32_t> indices;
+    for (size_t i = 0; i < states.size(); ++i) {
+        indices[states[i].get()] = static_cast<uint32_t>(i);
+    }
+
+    auto table = std::make_shared<CompiledDFA>(static_cast<uint32_t>(states.size()), indices[startState.get()]);
+    for (size_t i = 0; i < states.size(); ++i) {
+        for (const auto &[symbol, target]: states[i]->transitions) {
+            table->setTransition(static_cast<uint32_t>(i), static_cast<unsigned char>(symbol), indices[target.get()]);
+        }
+        if (states[i]->final) {
+            table->setAccepting(static_cast<uint32_t>(i));
+        }
+    }
+
+    table->compressAlphabet();
+    compiled = std::move(table);
+}
+
+FiniteAutomaton::~FiniteAutomaton() {
+    for (const auto &state: states) {
+        state->transitions.clear();
+    }
+    for (const auto &[name, state]: stateMap) {
+        state->transitions.clear();
+    }
+}
+
+void FiniteAutomaton::exportTo(std::ostream &os, const ExportFormat format) const {
+    std::vector<std::string> names;
+    std::vector<bool> accepting;
+    std::vector<ExportEdge> edges;
+    int start = -1;
+
+    if (!states.empty()) {
+        std::unordered_map<const State *, int> ids;
+        for (size_t i = 0; i < states.size(); ++i) {
+            ids[states[i].get()] = static_cast<int>(i);
+            names.push_back(states[i]->name);
+            accepting.push_back(states[i]->final);
+        }
+        for (size_t i = 0; i < states.size(); ++i) {
+            std::vector<std::pair<char, int> > sorted;
+            for (const auto &[symbol, target]: states[i]->transitions) {
+                sorted.emplace_back(symbol, ids[target.get()]);
+            }
+            std::sort(sorted.begin(), sorted.end());
+            for (const auto &[symbol, target]: sorted) {
+                edges.push_back({static_cast<int>(i), target, symbol});
+            }
+        }
+        start = startState ? ids[startState.get()] : -1;
+    } else if (compiled) {
+        // Dead state left out; the states after it move down by one.
+        const uint32_t dead = compiled->getDeadState();
+        auto id = [dead](const uint32_t state) { return static_cast<int>(state < dead ? state : state - 1); };
+
+        for (uint32_t state = 0; state < compiled->getStateCount(); ++state) {
+            if (state == dead) continue;
+            names.push_back("q" + std::to_string(id(state)));
+            accepting.push_back(compiled->isAccepting(state));
+            for (uint32_t symbol = 1; symbol < CompiledDFA::alphabetSize; ++symbol) {
+                if (const uint32_t target = compiled->next(state, static_cast<unsigned char>(symbol)); target != dead) {
+                    edges.push_back({id(state), id(target), static_cast<char>(symbol)});
+                }
+            }
+        }
+        start = compiled->getStartState() == dead ? -1 : id(compiled->getStartState());
+    } else {
+        throw std::runtime_error("Only automata with explicit states can be exported; compile with MatchEngine::DFA");
+    }
+
+    writeAutomaton(os, format, isNondeterministic() ? "NFA" : "DFA", names, start, accepting, edges);
+}
+
+void FiniteAutomaton::exportNFA(const std::string &postfix, std::ostream &os, const ExportFormat format) {
+    NFAGraph graph;
+    const RegToken token = RegToken::getENFAToken(postfix, graph);
+    graph.exportTo(os, format, token.startNode, token.endNode);
+}
+
+size_t FiniteAutomaton::getMemoryFootprint() const {
+    size_t bytes = sizeof(*this);
+
+    for (const auto &state: states) {
+        bytes += sizeof(State) + state->name.capacity()
+                + state->transitions.bucket_count() * sizeof(void *)
+                + state->transitions.size() * (sizeof(std::pair<const char, std::shared_ptr<State> >) + 2 * sizeof(void *));
+    }
+    bytes += states.capacity() * sizeof(std::shared_ptr<State>);
+    bytes += stateMap.size() * (sizeof(std::pair<const std::string, std::shared_ptr<State> >) + 2 * sizeof(void *));
+
+    if (compiled) bytes += compiled->getMemoryFootprint();
+    if (lazy) bytes += lazy->getMemoryFootprint();
+    if (bitParallel) bytes += bitParallel->getMemoryFootprint();
+    if (nfa) bytes += nfa->getMemoryFootprint();
+    if (literal) bytes += literal->getMemoryFootprint();
+
+    return bytes + literals.prefix.capacity() + literals.suffix.capacity() + literals.required.capacity();
+}
+
+void FiniteAutomaton::save(const std::string &path) const {
+    if (!compiled) {
+        throw std::runtime_error("Only automata compiled to a DFA table can be saved");
+    }
+    compiled->save(path);
+}
+
+FiniteAutomaton *FiniteAutomaton::load(const std::string &path) {
+    // Owned until returned, so a truncated or corrupt file (CompiledDFA::load throws) does not leak it.
+    std::unique_ptr<FiniteAutomaton> fa(new FiniteAutomaton());
+    fa->compiled = CompiledDFA::load(path);
+
+    // Sigma is every byte that leaves the dead state from somewhere.
+    const uint32_t dead = fa->compiled->getDeadState();
+    for (uint32_t symbol = 1; symbol < CompiledDFA::alphabetSize; ++symbol) {
+        for (uint32_t state = 0; state < fa->compiled->getStateCount(); ++state) {
+            if (fa->compiled->next(state, static_cast<unsigned char>(symbol)) != dead) {
+                fa->sigma.insert(static_cast<char>(symbol));
+                break;
+            }
+        }
+    }
+
+    return fa.release();
+}
+
+FiniteAutomaton *FiniteAutomaton::loadDefinition(const std::string &path) {
+    const Setup setup(path);
+    std::unique_ptr<FiniteAutomaton> fa(new FiniteAutomaton());
+
+    // One byte class per Sigma symbol, plus class 0 for every other byte (unless Sigma
+    // already covers all of them).
+    std::array<bool, CompiledDFA::alphabetSize> inSigma{};
+    for (const char symbol: setup.getSigma()) {
+        inSigma[static_cast<unsigned char>(symbol)] = true;
+    }
+    const bool everyByte = std::count(inSigma.begin(), inSigma.end(), true) == CompiledDFA::alphabetSize;
+
+    std::array<uint8_t, CompiledDFA::alphabetSize> classMap{};
+    uint32_t classCount = everyByte ? 0 : 1;
+    for (uint32_t symbol = 0; symbol < CompiledDFA::alphabetSize; ++symbol) {
+        if (inSigma[symbol]) {
+            classMap[symbol] = static_cast<uint8_t>(classCount++);
+        }
+    }
+
+    const auto liveStates = static_cast<uint32_t>(setup.getStates().size());
+    const uint32_t start = setup.getInitialState() == Setup::noState ? liveStates : setup.getInitialState();
+    auto table = std::make_shared<CompiledDFA>(liveStates, start, classMap, classCount);
+
+    for (const auto &[from, to, symbol]: setup.getTransitions()) {
+        const uint32_t current = table->next(from, static_cast<unsigned char>(symbol));
+        if (current != table->getDeadState() && current != to) {
+            // Two targets on one symbol: keep the explicit states instead.
+            fa->setDefinition(setup);
+            fa->compileNondeterministic(setup);
+            return fa.release();
+        }
+        table->setTransition(from, static_cast<unsigned char>(symbol), to);
+    }
+    for (uint32_t state = 0; state < liveStates; ++state) {
+        if (setup.getFinalStates()[state]) {
+            table->setAccepting(state);
+        }
+    }
+
+    fa->sigma.insert(setup.getSigma().begin(), setup.getSigma().end());
+    fa->compiled = std::move(table);
+    return fa.release();
+}
+
+bool FiniteAutomaton::process(const std::string &word, MatchStats &stats) const {
+    const auto start = std::chrono::steady_clock::now();
+    size_t transitions = 0;
+    bool accepted;
+
+    // Same walks as the engines' own loops, counting the transitions taken before getting stuck.
+    if (compiled) {
+        const uint32_t dead = compiled->getDeadState();
+        uint32_t state = compiled->getStartState();
+        for (size_t i = 0; i < word.size() && state != dead; ++i, ++transitions) {
+            state = compiled->next(state, static_cast<unsigned char>(word[i]));
+        }
+        accepted = state != dead && compiled->isAccepting(state);
+    } else if (bitParallel) {
+        uint64_t active = GlushkovMatcher::initialState();
+        for (size_t i = 0; i < word.size() && active != 0; ++i, ++transitions) {
+            active = bitParallel->step(active, static_cast<unsigned char>(word[i]));
+        }
+        accepted = bitParallel->isAccepting(active);
+    } else {
+        // The lazy DFA, the NFA simulation, the literal matcher and the State fallback do not
+        // expose their steps; count the input instead.
+        accepted = process(word);
+        transitions = word.size();
+    }
 
-    return temp;
+    stats.calls++;
+    stats.accepted += accepted;
+    stats.bytesProcessed += word.size();
+    stats.transitions += transitions;
+    stats.totalMs += elapsedMillis(start);
+    return accepted;
 }
 
 bool FiniteAutomaton::process(const std::string& word) const {
+    if (compiled) {
+        return compiled->process(word);
+    }
+    if (bitParallel) {
+        return bitParallel->process(word);
+    }
+    if (lazy) {
+        return lazy->process(word);
+    }
+    if (nfa) {
+        return nfa->process(word);
+    }
+    if (literal) {
+        return literal->process(word);
+    }
+
     auto currentState = startState;
     assert(currentState != nullptr);
 
@@ -407,11 +824,351 @@ bool FiniteAutomaton::process(const std::string& word) const {
     return currentState->final;
 }
 
-// To implement (Optional)
-// FiniteAutomaton* FiniteAutomaton::getMinimizedVersion() {
-//     if (!isNondeterministic()) {
-//         return nullptr;
-//     }
-//
-//     return nullptr;
-// }
+size_t FiniteAutomaton::longestMatch(const std::string_view text) const {
+    if (compiled) {
+        return compiled->longestMatch(text);
+    }
+    if (bitParallel) {
+        return bitParallel->longestMatch(text);
+    }
+    if (lazy) {
+        return lazy->longestMatch(text);
+    }
+    if (nfa) {
+        return nfa->longestMatch(text);
+    }
+    if (literal) {
+        return literal->longestMatch(text);
+    }
+
+    auto currentState = startState;
+    assert(currentState != nullptr);
+
+    size_t longest = currentState->final ? 0 : std::string_view::npos;
+    for (size_t i = 0; i < text.size(); ++i) {
+        auto transitionsWithSymbol = currentState->transitions.equal_range(text[i]);
+        if (transitionsWithSymbol.first == transitionsWithSymbol.second) {
+            break;
+        }
+        currentState = transitionsWithSymbol.first->second;
+        if (currentState->final) {
+            longest = i + 1;
+        }
+    }
+    return longest;
+}
+
+std::vector<std::pair<size_t, size_t> > FiniteAutomaton::search(const std::string_view text) const {
+    if (literal) {
+        return literal->search(text);
+    }
+
+    std::vector<std::pair<size_t, size_t> > spans;
+    const std::string_view prefix = literals.prefix;
+    const std::string_view required = literals.required;
+
+    size_t nextRequired = required.empty() ? 0 : text.find(required);
+    if (nextRequired == std::string_view::npos) {
+        return spans;
+    }
+
+    auto nextStart = [&](size_t position) {
+        // Every match starts with `prefix`: jump straight to its next occurrence.
+        if (!prefix.empty()) {
+            position = text.find(prefix, position);
+            if (position == std::string_view::npos) return position;
+        }
+
+        // Every match contains `required`: stop once it no longer occurs.
+        if (!required.empty() && nextRequired < position) {
+            nextRequired = text.find(required, position);
+            if (nextRequired == std::string_view::npos) return nextRequired;
+        }
+        return position;
+    };
+
+    if (compiled) {
+        return leftmostLongestSearch(
+            text, compiled->getStartState(), compiled->getDeadState(),
+            [&](const uint32_t state, const unsigned char symbol) { return compiled->next(state, symbol); },
+            [&](const uint32_t state) { return compiled->isAccepting(state); }, nextStart);
+    }
+    if (bitParallel) {
+        return leftmostLongestSearch(
+            text, GlushkovMatcher::initialState(), uint64_t{0},
+            [&](const uint64_t active, const unsigned char symbol) { return bitParallel->step(active, symbol); },
+            [&](const uint64_t active) { return bitParallel->isAccepting(active); }, nextStart);
+    }
+
+    // The lazy DFA renumbers its states when it flushes and the other engines are not
+    // deterministic, so they find the longest match of every candidate start in turn.
+    size_t position = 0;
+    while (position < text.size()) {
+        position = nextStart(position);
+        if (position == std::string_view::npos) break;
+
+        const size_t length = longestMatch(text.substr(position));
+        if (length != std::string_view::npos && length > 0) {
+            spans.emplace_back(position, position + length);
+            position += length;
+        } else {
+            ++position;
+        }
+    }
+
+    return spans;
+}
+
+StreamMatcher FiniteAutomaton::streamMatcher() const {
+    if (compiled) {
+        return StreamMatcher(compiled);
+    }
+    if (bitParallel) {
+        return StreamMatcher(bitParallel);
+    }
+    if (literal) {
+        return StreamMatcher(literal->toCompiledDFA());
+    }
+    throw std::runtime_error("Streaming needs a compiled DFA or bit-parallel automaton");
+}
+
+std::vector<uint64_t> FiniteAutomaton::processMany(const std::span<const std::string_view> words,
+                                                   const unsigned threads) const {
+    std::vector<uint64_t> bits((words.size() + 63) / 64, 0);
+
+    // Matches words[begin, end) into bits; begin is a multiple of 64, so concurrent
+    // blocks never write to the same bitmap word.
+    auto matchRange = [&](const size_t begin, const size_t end) {
+        const auto batch = words.subspan(begin, end - begin);
+        uint64_t *out = bits.data() + begin / 64;
+        if (compiled) {
+            compiled->processMany(batch, out);
+            return;
+        }
+        if (bitParallel) {
+            bitParallel->processMany(batch, out);
+            return;
+        }
+        if (nfa) {
+            nfa->processMany(batch, out);
+            return;
+        }
+        if (literal) {
+            literal->processMany(batch, out);
+            return;
+        }
+        for (size_t i = 0; i < batch.size(); ++i) {
+            if (lazy ? lazy->process(batch[i]) : process(std::string(batch[i]))) {
+                out[i >> 6] |= uint64_t{1} << (i & 63);
+            }
+        }
+    };
+
+    std::unique_ptr<ThreadPool> pool;
+    if (threads != 1 && words.size() >= 2 * batchChunkWords) {
+        pool = std::make_unique<ThreadPool>(threads == 0 ? std::thread::hardware_concurrency() : threads);
+    }
+    parallelFor(pool.get(), bits.size(), [&](const size_t begin, const size_t end) {
+        matchRange(begin * 64, std::min(words.size(), end * 64));
+    });
+
+    return bits;
+}
+
+bool FiniteAutomaton::processFile(const std::string &path) const {
+    StreamMatcher matcher = streamMatcher();
+    matcher.feedFile(path);
+    return matcher.finish();
+}
+
+// Hopcroft partition refinement, O(n * |Sigma| * log n).
+// Returns nullptr for nondeterministic automata.
+FiniteAutomaton *FiniteAutomaton::getMinimizedVersion() const {
+    if (!startState || isNondeterministic()) {
+        return nullptr;
+    }
+
+    std::vector<char> sigma_vec(sigma.begin(), sigma.end());
+    std::sort(sigma_vec.begin(), sigma_vec.end());
+    const size_t k = sigma_vec.size();
+
+    std::unordered_map<const State *, int> indices;
+    std::vector<const State *> reachable;
+    std::queue<const State *> toVisit;
+    indices[startState.get()] = 0;
+    reachable.push_back(startState.get());
+    toVisit.push(startState.get());
+    while (!toVisit.empty()) {
+        const State *current = toVisit.front();
+        toVisit.pop();
+        for (const auto &[symbol, target]: current->transitions) {
+            if (!indices.contains(target.get())) {
+                indices[target.get()] = static_cast<int>(reachable.size());
+                reachable.push_back(target.get());
+                toVisit.push(target.get());
+            }
+        }
+    }
+
+    // Total transition function over reachable states plus an explicit sink.
+    const int sink = static_cast<int>(reachable.size());
+    const int n = sink + 1;
+    std::vector<int> delta(static_cast<size_t>(n) * k, sink);
+    for (int s = 0; s < sink; ++s) {
+        for (size_t a = 0; a < k; ++a) {
+            auto [fst, snd] = reachable[s]->transitions.equal_range(sigma_vec[a]);
+            if (fst != snd) {
+                delta[s * k + a] = indices[fst->second.get()];
+            }
+        }
+    }
+
+    // Inverse transitions, one CSR block per symbol.
+    std::vector<std::vector<int> > inverseStart(k, std::vector<int>(n + 1, 0));
+    std::vector<std::vector<int> > inverse(k, std::vector<int>(n));
+    for (size_t a = 0; a < k; ++a) {
+        for (int s = 0; s < n; ++s) {
+            ++inverseStart[a][delta[s * k + a] + 1];
+        }
+        for (int t = 0; t < n; ++t) {
+            inverseStart[a][t + 1] += inverseStart[a][t];
+        }
+        std::vector<int> fill(inverseStart[a].begin(), inverseStart[a].end() - 1);
+        for (int s = 0; s < n; ++s) {
+            inverse[a][fill[delta[s * k + a]]++] = s;
+        }
+    }
+
+    // Blocks are contiguous ranges of `elements`; `location` is the inverse permutation.
+    std::vector<int> elements(n), location(n), blockOf(n);
+    std::vector<int> blockStart, blockEnd, marked;
+    int front = 0, back = n;
+    for (int s = 0; s < n; ++s) {
+        if (s != sink && reachable[s]->final) {
+            elements[front++] = s;
+        } else {
+            elements[--back] = s;
+        }
+    }
+    for (int i = 0; i < n; ++i) {
+        location[elements[i]] = i;
+    }
+    if (front > 0) {
+        blockStart.push_back(0);
+        blockEnd.push_back(front);
+    }
+    blockStart.push_back(front);
+    blockEnd.push_back(n);
+    for (size_t b = 0; b < blockStart.size(); ++b) {
+        for (int i = blockStart[b]; i < blockEnd[b]; ++i) {
+            blockOf[elements[i]] = static_cast<int>(b);
+        }
+    }
+    marked.assign(blockStart.size(), 0);
+
+    std::vector<std::pair<int, size_t> > worklist;
+    std::vector<std::vector<bool> > inWorklist(blockStart.size(), std::vector<bool>(k, false));
+    const int smallest = (blockStart.size() == 2 && blockEnd[0] - blockStart[0] > blockEnd[1] - blockStart[1]) ? 1 : 0;
+    for (size_t a = 0; a < k; ++a) {
+        worklist.emplace_back(smallest, a);
+        inWorklist[smallest][a] = true;
+    }
+
+    std::vector<int> splitter, touched;
+    while (!worklist.empty()) {
+        auto [block, a] = worklist.back();
+        worklist.pop_back();
+        inWorklist[block][a] = false;
+
+        splitter.assign(elements.begin() + blockStart[block], elements.begin() + blockEnd[block]);
+        for (const int target: splitter) {
+            for (int i = inverseStart[a][target]; i < inverseStart[a][target + 1]; ++i) {
+                const int s = inverse[a][i];
+                const int b = blockOf[s];
+                if (marked[b] == 0) {
+                    touched.push_back(b);
+                }
+                const int to = blockStart[b] + marked[b]++;
+                const int other = elements[to];
+                std::swap(elements[location[s]], elements[to]);
+                location[other] = location[s];
+                location[s] = to;
+            }
+        }
+
+        for (const int b: touched) {
+            const int count = marked[b];
+            marked[b] = 0;
+            if (count == blockEnd[b] - blockStart[b]) {
+                continue;
+            }
+
+            const int created = static_cast<int>(blockStart.size());
+            blockStart.push_back(blockStart[b]);
+            blockEnd.push_back(blockStart[b] + count);
+            blockStart[b] += count;
+            marked.push_back(0);
+            inWorklist.emplace_back(k, false);
+            for (int i = blockStart[created]; i < blockEnd[created]; ++i) {
+                blockOf[elements[i]] = created;
+            }
+
+            const bool createdIsSmaller = count <= blockEnd[b] - blockStart[b];
+            for (size_t c = 0; c < k; ++c) {
+                const int pick = (inWorklist[b][c] || createdIsSmaller) ? created : b;
+                if (!inWorklist[pick][c]) {
+                    worklist.emplace_back(pick, c);
+                    inWorklist[pick][c] = true;
+                }
+            }
+        }
+        touched.clear();
+    }
+
+    // Number the surviving blocks in BFS order from the start; the sink block is dropped.
+    const int sinkBlock = blockOf[sink];
+    std::vector<int> blockIndex(blockStart.size(), -1);
+    std::vector<int> order;
+    blockIndex[blockOf[0]] = 0;
+    order.push_back(blockOf[0]);
+    for (size_t i = 0; i < order.size(); ++i) {
+        const int representative = elements[blockStart[order[i]]];
+        for (size_t a = 0; a < k; ++a) {
+            const int target = blockOf[delta[representative * k + a]];
+            if (target != sinkBlock && blockIndex[target] == -1) {
+                blockIndex[target] = static_cast<int>(order.size());
+                order.push_back(target);
+            }
+        }
+    }
+
+    auto minimized = new FiniteAutomaton();
+    minimized->setSigma(sigma);
+    std::vector<std::shared_ptr<State> > fa_states(order.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        auto state = std::make_shared<State>();
+        const int representative = elements[blockStart[order[i]]];
+        state->name = "q" + std::to_string(i);
+        state->initial = (i == 0);
+        state->final = representative != sink && reachable[representative]->final;
+        fa_states[i] = state;
+    }
+
+    for (size_t i = 0; i < order.size(); ++i) {
+        const int representative = elements[blockStart[order[i]]];
+        if (order[i] == sinkBlock) {
+            continue;
+        }
+        for (size_t a = 0; a < k; ++a) {
+            if (const int target = blockOf[delta[representative * k + a]]; target != sinkBlock) {
+                fa_states[i]->transitions.emplace(sigma_vec[a], fa_states[blockIndex[target]]);
+            }
+        }
+    }
+
+    minimized->states = fa_states;
+    minimized->startState = fa_states[0];
+    minimized->compile();
+
+    return minimized;
+}
@@ -0,0 +1,139 @@
+#include <algorithm>
+#include <bit>
+#include <stack>
+#include <stdexcept>
+#include <unordered_set>
+
+#include "GlushkovMatcher.h"
+
+namespace {
+    struct Fragment {
+        bool nullable;
+        uint64_t first;
+        uint64_t last;
+    };
+
+    void linkFollow(std::array<uint64_t, 64> &follow, uint64_t from, const uint64_t to) {
+        for (; from != 0; from &= from - 1) {
+            follow[std::countr_zero(from)] |= to;
+        }
+    }
+}
+
+std::shared_ptr<GlushkovMatcher> GlushkovMatcher::build(const std::string &postfix) {
+    const std::unordered_set<char> binary = {'.', '|'};
+    const std::unordered_set<char> unary = {'*', '+', '?'};
+
+    std::shared_ptr<GlushkovMatcher> matcher(new GlushkovMatcher());
+    std::array<uint64_t, 64> follow{};
+    std::stack<Fragment> fragments;
+
+    for (const char c: postfix) {
+        if (binary.contains(c) || unary.contains(c)) {
+            const size_t operands = binary.contains(c) ? 2 : 1;
+            if (fragments.size() < operands) {
+                throw std::runtime_error("Postfix expression is wrong");
+            }
+
+            Fragment rhs = fragments.top();
+            fragments.pop();
+
+            switch (c) {
+                case '.': {
+                    Fragment lhs = fragments.top();
+                    fragments.pop();
+                    linkFollow(follow, lhs.last, rhs.first);
+                    fragments.push({
+                        lhs.nullable && rhs.nullable,
+                        lhs.first | (lhs.nullable ? rhs.first : 0),
+                        rhs.last | (rhs.nullable ? lhs.last : 0)
+                    });
+                    break;
+                }
+                case '|': {
+                    Fragment lhs = fragments.top();
+                    fragments.pop();
+                    fragments.push({lhs.nullable || rhs.nullable, lhs.first | rhs.first, lhs.last | rhs.last});
+                    break;
+                }
+                case '*':
+                    linkFollow(follow, rhs.last, rhs.first);
+                    fragments.push({true, rhs.first, rhs.last});
+                    break;
+                case '+':
+                    linkFollow(follow, rhs.last, rhs.first);
+                    fragments.push(rhs);
+                    break;
+                default:
+                    fragments.push({true, rhs.first, rhs.last});
+                    break;
+            }
+        } else {
+            if (matcher->positions == maxPositions) {
+                return nullptr;
+            }
+            const uint64_t position = uint64_t{1} << ++matcher->positions;
+            matcher->symbolMasks[static_cast<unsigned char>(c)] |= position;
+            fragments.push({false, position, position});
+        }
+    }
+
+    if (fragments.size() != 1) {
+        throw std::runtime_error("Postfix expression is wrong");
+    }
+
+    const Fragment root = fragments.top();
+    follow[0] = root.first;
+    matcher->acceptMask = root.last | (root.nullable ? initialState() : 0);
+
+    const int chunks = (matcher->positions + chunkBits) / chunkBits;
+    matcher->followTables.resize(chunks);
+    for (int k = 0; k < chunks; ++k) {
+        auto &table = matcher->followTables[k];
+        for (int bits = 1; bits < (1 << chunkBits); ++bits) {
+            const int low = std::countr_zero(static_cast<unsigned>(bits));
+            const int position = k * chunkBits + low;
+            table[bits] = table[bits & (bits - 1)] | (position < 64 ? follow[position] : 0);
+        }
+    }
+
+    return matcher;
+}
+
+size_t GlushkovMatcher::longestMatch(const std::string_view text) const {
+    uint64_t active = initialState();
+    size_t longest = isAccepting(active) ? 0 : std::string_view::npos;
+
+    for (size_t i = 0; i < text.size() && active != 0; ++i) {
+        active = step(active, static_cast<unsigned char>(text[i]));
+        if (isAccepting(active)) {
+            longest = i + 1;
+        }
+    }
+
+    return longest;
+}
+
+bool GlushkovMatcher::process(const std::string_view word) const {
+    uint64_t active = initialState();
+
+    for (const unsigned char symbol: word) {
+        active = step(active, symbol);
+        if (active == 0) {
+            return false;
+        }
+    }
+
+    return isAccepting(active);
+}
+
+void GlushkovMatcher::processMany(const std::span<const std::string_view> words, uint64_t *bits) const {
+    for (size_t i = 0; i < words.size(); i += 64) {
+        const size_t end = std::min(words.size(), i + 64);
+        uint64_t packed = 0;
+        for (size_t j = i; j < end; ++j) {
+            packed |= static_cast<uint64_t>(process(words[j])) << (j - i);
+        }
+        bits[i >> 6] = packed;
+    }
+}
@@ -0,0 +1,165 @@
+#include <algorithm>
+#include <stack>
+
+#include "LazyDFA.h"
+
+LazyDFA::LazyDFA(NFAGraph graph, const int startNode, const int endNode, const size_t memoryBudget)
+    : graph(std::move(graph)), endNode(endNode), memoryBudget(memoryBudget) {
+    classSymbol.push_back(0);
+    for (int node = 0; node < this->graph.size(); ++node) {
+        for (const auto &[target, symbol]: this->graph.connections(node)) {
+            const auto byte = static_cast<unsigned char>(symbol);
+            if (symbol != '\0' && classMap[byte] == rejectClass) {
+                classMap[byte] = static_cast<uint8_t>(classSymbol.size());
+                classSymbol.push_back(byte);
+            }
+        }
+    }
+
+    startCluster = StateCluster(this->graph.size());
+    startCluster.insert(startNode);
+    closeOver(startCluster);
+
+    const size_t stateBytes = classCount() * sizeof(int32_t) + sizeof(StateCluster)
+                              + (this->graph.size() + 63) / 64 * sizeof(uint64_t) + 2 * sizeof(int);
+    maxStates = std::max<size_t>(memoryBudget / stateBytes, 2);
+
+    addState(startCluster);
+}
+
+void LazyDFA::closeOver(StateCluster &cluster) const {
+    std::stack<int> toExplore;
+    cluster.forEach([&](const int id) {
+        toExplore.push(id);
+    });
+
+    while (!toExplore.empty()) {
+        const int node = toExplore.top();
+        toExplore.pop();
+
+        for (const auto &[target, symbol]: graph.connections(node)) {
+            if (symbol == '\0' && !cluster.contains(target)) {
+                cluster.insert(target);
+                toExplore.push(target);
+            }
+        }
+    }
+}
+
+StateCluster LazyDFA::step(const StateCluster &cluster, const unsigned char symbol) const {
+    StateCluster result = cluster.stepWith(static_cast<char>(symbol), graph);
+    closeOver(result);
+    return result;
+}
+
+int LazyDFA::addState(const StateCluster &cluster) const {
+    const int index = states.insert(cluster).first;
+    rows.resize(rows.size() + classCount(), unknownState);
+    rows[index * classCount() + rejectClass] = deadState;
+    accepting.push_back(cluster.contains(endNode));
+    return index;
+}
+
+void LazyDFA::flush() const {
+    states.clear();
+    rows.clear();
+    accepting.clear();
+    addState(startCluster);
+    consumedSinceFlush = 0;
+    ++flushCount;
+}
+
+size_t LazyDFA::simulate(StateCluster current, const std::string_view text, const size_t from, size_t matched,
+                         const bool longest) const {
+    if (longest && current.contains(endNode)) {
+        matched = from;
+    }
+
+    for (size_t i = from; i < text.size(); ++i) {
+        // Bytes of the reject class (NUL among them) label no edge; stepping on the raw
+        // byte would follow the epsilon edges instead.
+        const uint8_t cls = classMap[static_cast<unsigned char>(text[i])];
+        if (cls == rejectClass) {
+            return longest ? matched : std::string_view::npos;
+        }
+        current = step(current, classSymbol[cls]);
+        if (current.isEmpty()) {
+            return longest ? matched : std::string_view::npos;
+        }
+        if (longest && current.contains(endNode)) {
+            matched = i + 1;
+        }
+    }
+
+    if (longest) {
+        return matched;
+    }
+    return current.contains(endNode) ? text.size() : std::string_view::npos;
+}
+
+size_t LazyDFA::run(const std::string_view text, const bool longest) const {
+    std::lock_guard lock(cacheMutex);
+
+    int32_t state = 0;
+    size_t matched = accepting[state] ? 0 : std::string_view::npos;
+
+    for (size_t i = 0; i < text.size(); ++i) {
+        const uint8_t cls = classMap[static_cast<unsigned char>(text[i])];
+        int32_t &cell = rows[state * classCount() + cls];
+        int32_t next = cell;
+
+        if (next == unknownState) {
+            StateCluster target = step(states[state], classSymbol[cls]);
+
+            if (target.isEmpty()) {
+                next = deadState;
+                cell = next;
+            } else if ((next = states.find(target)) != -1) {
+                cell = next;
+            } else if (static_cast<size_t>(states.size()) < maxStates) {
+                next = addState(target);
+                rows[state * classCount() + cls] = next;
+            } else if (consumedSinceFlush < maxStates) {
+                // The cache is thrashing: finish this input without caching. The simulated
+                // bytes still count, so inputs the stale cache keeps missing do flush it.
+                consumedSinceFlush += text.size() - i;
+                return simulate(std::move(target), text, i + 1, matched, longest);
+            } else {
+                flush();
+                next = addState(target);
+            }
+        }
+
+        if (next == deadState) {
+            return longest ? matched : std::string_view::npos;
+        }
+        state = next;
+        ++consumedSinceFlush;
+        if (longest && accepting[state]) {
+            matched = i + 1;
+        }
+    }
+
+    if (longest) {
+        return matched;
+    }
+    return accepting[state] ? text.size() : std::string_view::npos;
+}
+
+bool LazyDFA::process(const std::string_view word) const {
+    return run(word, false) != std::string_view::npos;
+}
+
+size_t LazyDFA::longestMatch(const std::string_view text) const {
+    return run(text, true);
+}
+
+size_t LazyDFA::getCachedStates() const {
+    std::lock_guard lock(cacheMutex);
+    return states.size();
+}
+
+size_t LazyDFA::getFlushCount() const {
+    std::lock_guard lock(cacheMutex);
+    return flushCount;
+}
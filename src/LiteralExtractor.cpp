@@ -0,0 +1,143 @@
+#include <algorithm>
+#include <optional>
+#include <stack>
+#include <stdexcept>
+#include <unordered_set>
+
+#include "LiteralExtractor.h"
+
+namespace {
+    struct Fragment {
+        // Set when the fragment matches exactly one string.
+        std::optional<std::string> exact;
+        RegexLiterals literals;
+        // Set while the fragment matches a small finite set of strings (sorted, unique).
+        std::optional<std::vector<std::string> > strings;
+    };
+
+    Fragment exactFragment(std::string value) {
+        return {value, {value, value, value, {}}, std::vector{value}};
+    }
+
+    std::optional<std::vector<std::string> > concatenateStrings(const Fragment &lhs, const Fragment &rhs) {
+        if (!lhs.strings || !rhs.strings
+            || lhs.strings->size() * rhs.strings->size() > LiteralExtractor::maxLanguageSize) {
+            return std::nullopt;
+        }
+        std::vector<std::string> result;
+        for (const auto &head: *lhs.strings) {
+            for (const auto &tail: *rhs.strings) {
+                result.push_back(head + tail);
+            }
+        }
+        std::sort(result.begin(), result.end());
+        result.erase(std::unique(result.begin(), result.end()), result.end());
+        return result;
+    }
+
+    std::optional<std::vector<std::string> > alternateStrings(const Fragment &lhs, const Fragment &rhs) {
+        if (!lhs.strings || !rhs.strings) {
+            return std::nullopt;
+        }
+        std::vector<std::string> result;
+        std::set_union(lhs.strings->begin(), lhs.strings->end(), rhs.strings->begin(), rhs.strings->end(),
+                       std::back_inserter(result));
+        if (result.size() > LiteralExtractor::maxLanguageSize) {
+            return std::nullopt;
+        }
+        return result;
+    }
+
+    const std::string &longest(const std::string &a, const std::string &b) {
+        return a.size() >= b.size() ? a : b;
+    }
+
+    std::string commonPrefix(const std::string &a, const std::string &b) {
+        size_t i = 0;
+        while (i < a.size() && i < b.size() && a[i] == b[i]) ++i;
+        return a.substr(0, i);
+    }
+
+    std::string commonSuffix(const std::string &a, const std::string &b) {
+        size_t i = 0;
+        while (i < a.size() && i < b.size() && a[a.size() - 1 - i] == b[b.size() - 1 - i]) ++i;
+        return a.substr(a.size() - i);
+    }
+
+    Fragment concatenate(const Fragment &lhs, const Fragment &rhs) {
+        if (lhs.exact && rhs.exact) {
+            return exactFragment(*lhs.exact + *rhs.exact);
+        }
+
+        Fragment result;
+        result.literals.prefix = lhs.exact ? *lhs.exact + rhs.literals.prefix : lhs.literals.prefix;
+        result.literals.suffix = rhs.exact ? lhs.literals.suffix + *rhs.exact : rhs.literals.suffix;
+        result.literals.required = longest(longest(lhs.literals.required, rhs.literals.required),
+                                           lhs.literals.suffix + rhs.literals.prefix);
+        result.literals.required = longest(result.literals.required,
+                                           longest(result.literals.prefix, result.literals.suffix));
+        return result;
+    }
+
+    Fragment alternate(const Fragment &lhs, const Fragment &rhs) {
+        if (lhs.exact && rhs.exact && *lhs.exact == *rhs.exact) {
+            return lhs;
+        }
+
+        Fragment result;
+        result.literals.prefix = commonPrefix(lhs.literals.prefix, rhs.literals.prefix);
+        result.literals.suffix = commonSuffix(lhs.literals.suffix, rhs.literals.suffix);
+        result.literals.required = longest(result.literals.prefix, result.literals.suffix);
+        return result;
+    }
+}
+
+RegexLiterals LiteralExtractor::extract(const std::string &postfix) {
+    const std::unordered_set<char> binary = {'.', '|'};
+    const std::unordered_set<char> unary = {'*', '+', '?'};
+    std::stack<Fragment> fragments;
+
+    for (const char c: postfix) {
+        if (binary.contains(c) || unary.contains(c)) {
+            const size_t operands = binary.contains(c) ? 2 : 1;
+            if (fragments.size() < operands) {
+                throw std::runtime_error("Postfix expression is wrong");
+            }
+
+            Fragment rhs = fragments.top();
+            fragments.pop();
+
+            if (c == '.' || c == '|') {
+                Fragment lhs = fragments.top();
+                fragments.pop();
+                Fragment result = c == '.' ? concatenate(lhs, rhs) : alternate(lhs, rhs);
+                result.strings = c == '.' ? concatenateStrings(lhs, rhs) : alternateStrings(lhs, rhs);
+                fragments.push(std::move(result));
+            } else if (c == '+') {
+                rhs.exact.reset();
+                rhs.strings.reset();
+                fragments.push(rhs);
+            } else {
+                // '*' and '?' also match the empty string, so nothing is required. An
+                // optional finite set stays finite, with the empty string added.
+                Fragment result;
+                if (c == '?' && rhs.strings) {
+                    result.strings = alternateStrings(rhs, exactFragment(""));
+                }
+                fragments.push(std::move(result));
+            }
+        } else {
+            fragments.push(exactFragment(std::string(1, c)));
+        }
+    }
+
+    if (fragments.size() != 1) {
+        throw std::runtime_error("Postfix expression is wrong");
+    }
+
+    RegexLiterals result = fragments.top().literals;
+    if (fragments.top().strings) {
+        result.language = std::move(*fragments.top().strings);
+    }
+    return result;
+}
@@ -0,0 +1,298 @@
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <queue>
+
+#include "LiteralMatcher.h"
+
+namespace {
+    constexpr uint64_t golden = 0x9e3779b97f4a7c15;
+    // Seeds tried per bucket before the slot table is doubled, and the most doublings.
+    constexpr uint32_t maxSeeds = 1 << 12;
+    constexpr int maxDoublings = 8;
+
+    uint64_t mix(uint64_t value) {
+        value ^= value >> 33;
+        value *= 0xff51afd7ed558ccd;
+        value ^= value >> 33;
+        value *= 0xc4ceb9fe1a85ec53;
+        return value ^ (value >> 33);
+    }
+
+    // Eight bytes at a time; the final mix spreads every input bit over the whole hash.
+    uint64_t hashBytes(const std::string_view text) {
+        uint64_t hash = golden ^ text.size();
+        size_t i = 0;
+        for (; i + 8 <= text.size(); i += 8) {
+            uint64_t word;
+            std::memcpy(&word, text.data() + i, 8);
+            hash = std::rotl((hash ^ word) * golden, 29);
+        }
+        uint64_t tail = 0;
+        std::memcpy(&tail, text.data() + i, text.size() - i);
+        return mix((hash ^ tail) * golden);
+    }
+
+    size_t bucketIndex(const uint64_t hash, const size_t buckets) {
+        return (hash >> 32) & (buckets - 1);
+    }
+
+    size_t slotIndex(const uint64_t hash, const uint32_t seed, const size_t slots) {
+        return mix(hash + seed * golden) & (slots - 1);
+    }
+}
+
+std::shared_ptr<LiteralMatcher> LiteralMatcher::build(std::vector<std::string> literals) {
+    std::sort(literals.begin(), literals.end());
+    literals.erase(std::unique(literals.begin(), literals.end()), literals.end());
+    if (literals.empty() || literals.size() >= noEntry) {
+        return nullptr;
+    }
+
+    std::shared_ptr<LiteralMatcher> matcher(new LiteralMatcher());
+    matcher->literals = std::move(literals);
+    const auto [shortest, longest] = std::minmax_element(
+        matcher->literals.begin(), matcher->literals.end(),
+        [](const std::string &lhs, const std::string &rhs) { return lhs.size() < rhs.size(); });
+    matcher->minLength = shortest->size();
+    matcher->maxLength = longest->size();
+
+    std::array<bool, 256> used{};
+    for (const auto &literal: matcher->literals) {
+        for (const char c: literal) {
+            used[static_cast<unsigned char>(c)] = true;
+        }
+    }
+    const auto unused = std::find(used.begin(), used.end(), false);
+    if (unused == used.end()) {
+        // No byte left for the shared class of unused bytes.
+        return nullptr;
+    }
+    matcher->classSymbol.push_back(static_cast<unsigned char>(unused - used.begin()));
+    for (uint32_t byte = 0; byte < 256; ++byte) {
+        if (used[byte]) {
+            matcher->classMap[byte] = static_cast<uint8_t>(matcher->classSymbol.size());
+            matcher->classSymbol.push_back(static_cast<unsigned char>(byte));
+        }
+    }
+
+    if (matcher->literals.size() > 1) {
+        matcher->buildHash();
+        if (matcher->slots.empty()) {
+            return nullptr;
+        }
+    }
+    matcher->buildTrie();
+    return matcher;
+}
+
+void LiteralMatcher::buildHash() {
+    const size_t count = literals.size();
+    std::vector<uint64_t> hashes(count);
+    for (size_t i = 0; i < count; ++i) {
+        hashes[i] = hashBytes(literals[i]);
+    }
+
+    // About four keys per bucket and a load factor of at most one half. The largest
+    // buckets are placed first, while most slots are still free.
+    const size_t bucketCount = std::bit_ceil(std::max<size_t>(1, count / 4));
+    std::vector<std::vector<uint32_t> > buckets(bucketCount);
+    for (uint32_t i = 0; i < count; ++i) {
+        buckets[bucketIndex(hashes[i], bucketCount)].push_back(i);
+    }
+    std::vector<uint32_t> order(bucketCount);
+    for (uint32_t i = 0; i < bucketCount; ++i) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](const uint32_t lhs, const uint32_t rhs) {
+        return buckets[lhs].size() > buckets[rhs].size();
+    });
+
+    size_t slotCount = std::bit_ceil(2 * count);
+    std::vector<size_t> placed;
+    for (int attempt = 0; attempt <= maxDoublings; ++attempt, slotCount *= 2) {
+        slots.assign(slotCount, noEntry);
+        bucketSeeds.assign(bucketCount, 0);
+
+        bool complete = true;
+        for (const uint32_t bucket: order) {
+            const auto &members = buckets[bucket];
+            if (members.empty()) break;
+
+            bool seated = false;
+            for (uint32_t seed = 0; seed < maxSeeds && !seated; ++seed) {
+                placed.clear();
+                seated = true;
+                for (const uint32_t member: members) {
+                    const size_t slot = slotIndex(hashes[member], seed, slotCount);
+                    if (slots[slot] != noEntry || std::find(placed.begin(), placed.end(), slot) != placed.end()) {
+                        seated = false;
+                        break;
+                    }
+                    placed.push_back(slot);
+                }
+                if (seated) {
+                    for (size_t i = 0; i < members.size(); ++i) {
+                        slots[placed[i]] = members[i];
+                    }
+                    bucketSeeds[bucket] = seed;
+                }
+            }
+            if (!seated) {
+                complete = false;
+                break;
+            }
+        }
+        if (complete) return;
+    }
+
+    slots.clear();
+    bucketSeeds.clear();
+}
+
+void LiteralMatcher::buildTrie() {
+    const size_t k = classCount();
+    children.assign(k, noEntry);
+    depth = {0};
+    terminal = {false};
+
+    for (const auto &literal: literals) {
+        uint32_t node = 0;
+        for (const char c: literal) {
+            const size_t edge = node * k + classMap[static_cast<unsigned char>(c)];
+            if (children[edge] == noEntry) {
+                children[edge] = static_cast<uint32_t>(depth.size());
+                children.resize(children.size() + k, noEntry);
+                depth.push_back(depth[node] + 1);
+                terminal.push_back(false);
+            }
+            node = children[edge];
+        }
+        terminal[node] = true;
+    }
+
+    // Breadth-first, so the failure node of every node (a shorter suffix) is complete first.
+    const size_t nodes = depth.size();
+    next.assign(nodes * k, 0);
+    longestOutput.assign(nodes, 0);
+    std::vector<uint32_t> failure(nodes, 0);
+    std::queue<uint32_t> toVisit;
+    toVisit.push(0);
+    while (!toVisit.empty()) {
+        const uint32_t node = toVisit.front();
+        toVisit.pop();
+        longestOutput[node] = terminal[node] && node != 0 ? depth[node] : longestOutput[failure[node]];
+
+        for (size_t cls = 0; cls < k; ++cls) {
+            const uint32_t fallback = node == 0 ? 0 : next[failure[node] * k + cls];
+            if (const uint32_t child = children[node * k + cls]; child != noEntry) {
+                failure[child] = fallback;
+                next[node * k + cls] = child;
+                toVisit.push(child);
+            } else {
+                next[node * k + cls] = fallback;
+            }
+        }
+    }
+}
+
+uint32_t LiteralMatcher::slotOf(const std::string_view word) const {
+    const uint64_t hash = hashBytes(word);
+    return slots[slotIndex(hash, bucketSeeds[bucketIndex(hash, bucketSeeds.size())], slots.size())];
+}
+
+bool LiteralMatcher::process(const std::string_view word) const {
+    if (word.size() < minLength || word.size() > maxLength) {
+        return false;
+    }
+    if (literals.size() == 1) {
+        return std::memcmp(word.data(), literals[0].data(), word.size()) == 0;
+    }
+    const uint32_t index = slotOf(word);
+    return index != noEntry && literals[index] == word;
+}
+
+void LiteralMatcher::processMany(const std::span<const std::string_view> words, uint64_t *bits) const {
+    for (size_t i = 0; i < words.size(); i += 64) {
+        const size_t end = std::min(words.size(), i + 64);
+        uint64_t packed = 0;
+        for (size_t j = i; j < end; ++j) {
+            packed |= static_cast<uint64_t>(process(words[j])) << (j - i);
+        }
+        bits[i >> 6] = packed;
+    }
+}
+
+size_t LiteralMatcher::longestMatch(const std::string_view text) const {
+    const size_t k = classCount();
+    size_t longest = terminal[0] ? 0 : std::string_view::npos;
+    uint32_t node = 0;
+    for (size_t i = 0; i < text.size(); ++i) {
+        node = children[node * k + classMap[static_cast<unsigned char>(text[i])]];
+        if (node == noEntry) break;
+        if (terminal[node]) longest = i + 1;
+    }
+    return longest;
+}
+
+std::vector<std::pair<size_t, size_t> > LiteralMatcher::search(const std::string_view text) const {
+    std::vector<std::pair<size_t, size_t> > spans;
+    if (maxLength == 0) {
+        return spans;
+    }
+
+    if (literals.size() == 1) {
+        const std::string_view literal = literals[0];
+        for (size_t position = text.find(literal); position != std::string_view::npos;
+             position = text.find(literal, position + literal.size())) {
+            spans.emplace_back(position, position + literal.size());
+        }
+        return spans;
+    }
+
+    const size_t k = classCount();
+    uint32_t state = 0;
+    for (size_t i = 0; i < text.size(); ++i) {
+        state = next[state * k + classMap[static_cast<unsigned char>(text[i])]];
+        if (longestOutput[state] == 0) continue;
+
+        // A literal ends here. No match can start before the deepest trie prefix that also
+        // ends here (it would still be in that prefix), and one starts at end - longestOutput,
+        // so the leftmost match starts in between.
+        const size_t end = i + 1;
+        for (size_t start = end - depth[state]; start <= end - longestOutput[state]; ++start) {
+            const size_t length = longestMatch(text.substr(start));
+            if (length != std::string_view::npos && length > 0) {
+                spans.emplace_back(start, start + length);
+                i = start + length - 1;
+                break;
+            }
+        }
+        state = 0;
+    }
+    return spans;
+}
+
+std::shared_ptr<const CompiledDFA> LiteralMatcher::toCompiledDFA() const {
+    const size_t k = classCount();
+    const auto nodes = static_cast<uint32_t>(depth.size());
+    auto table = std::make_shared<CompiledDFA>(nodes, 0, classMap, static_cast<uint32_t>(k));
+    for (uint32_t node = 0; node < nodes; ++node) {
+        for (size_t cls = 0; cls < k; ++cls) {
+            if (const uint32_t child = children[node * k + cls]; child != noEntry) {
+                table->setTransition(node, classSymbol[cls], child);
+            }
+        }
+        if (terminal[node]) {
+            table->setAccepting(node);
+        }
+    }
+    return table;
+}
+
+size_t LiteralMatcher::getMemoryFootprint() const {
+    size_t bytes = sizeof(*this) + literals.capacity() * sizeof(std::string);
+    for (const auto &literal: literals) {
+        bytes += literal.capacity();
+    }
+    return bytes + (bucketSeeds.capacity() + slots.capacity() + children.capacity() + next.capacity()
+                    + depth.capacity() + longestOutput.capacity()) * sizeof(uint32_t) + terminal.capacity() / 8;
+}
@@ -0,0 +1,51 @@
+#include "NFAGraph.h"
+
+void NFAGraph::finalize() {
+    // Edges packed by an earlier finalize() are merged back in first, so several
+    // fragments can be built into one graph.
+    if (!edges.empty()) {
+        std::vector<std::tuple<int, int, char>> merged;
+        merged.reserve(edges.size() + pending.size());
+        for (int node = 0; node + 1 < static_cast<int>(edgeOffsets.size()); ++node) {
+            for (const auto &[target, symbol]: connections(node)) {
+                merged.emplace_back(node, target, symbol);
+            }
+        }
+        merged.insert(merged.end(), pending.begin(), pending.end());
+        pending = std::move(merged);
+    }
+
+    edgeOffsets.assign(nodeCount + 1, 0);
+    for (const auto &[from, to, symbol]: pending) {
+        ++edgeOffsets[from + 1];
+    }
+    for (int i = 0; i < nodeCount; ++i) {
+        edgeOffsets[i + 1] += edgeOffsets[i];
+    }
+
+    // Counting sort keeps the insertion order of each node's edges.
+    edges.resize(pending.size());
+    std::vector<int> fill(edgeOffsets.begin(), edgeOffsets.end() - 1);
+    for (const auto &[from, to, symbol]: pending) {
+        edges[fill[from]++] = {to, symbol};
+    }
+
+    pending.clear();
+    pending.shrink_to_fit();
+}
+
+void NFAGraph::exportTo(std::ostream &os, const ExportFormat format, const int startNode, const int endNode) const {
+    std::vector<std::string> names;
+    std::vector<bool> accepting;
+    std::vector<ExportEdge> exported;
+
+    for (int node = 0; node < nodeCount; ++node) {
+        names.push_back(toString(node));
+        accepting.push_back(node == endNode);
+        for (const auto &[target, symbol]: connections(node)) {
+            exported.push_back({node, target, symbol});
+        }
+    }
+
+    writeAutomaton(os, format, "NFA", names, startNode, accepting, exported);
+}
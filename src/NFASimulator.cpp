@@ -0,0 +1,177 @@
+#include <algorithm>
+#include <bit>
+
+#include "NFASimulator.h"
+#include "StateCluster.h"
+
+NFASimulator::NFASimulator(const Setup &setup)
+    : stateCount(static_cast<uint32_t>(setup.getStates().size())), wordCount((stateCount + 63) / 64) {
+    const auto &transitions = setup.getTransitions();
+
+    std::array<bool, 256> used{};
+    for (const auto &transition: transitions) {
+        used[static_cast<unsigned char>(transition.symbol)] = true;
+    }
+    if (const auto unused = std::find(used.begin(), used.end(), false); unused != used.end()) {
+        classSymbol.push_back(static_cast<unsigned char>(unused - used.begin()));
+    }
+    for (uint32_t byte = 0; byte < 256; ++byte) {
+        if (used[byte]) {
+            classMap[byte] = static_cast<uint8_t>(classSymbol.size());
+            classSymbol.push_back(static_cast<unsigned char>(byte));
+        }
+    }
+
+    // Counting sort of the transitions by (class, source state).
+    offsets.assign(classCount() * stateCount + 1, 0);
+    for (const auto &[from, to, symbol]: transitions) {
+        ++offsets[classMap[static_cast<unsigned char>(symbol)] * stateCount + from + 1];
+    }
+    for (size_t i = 1; i < offsets.size(); ++i) {
+        offsets[i] += offsets[i - 1];
+    }
+    targets.resize(transitions.size());
+    std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+    for (const auto &[from, to, symbol]: transitions) {
+        targets[fill[classMap[static_cast<unsigned char>(symbol)] * stateCount + from]++] = to;
+    }
+
+    startSet.assign(wordCount, 0);
+    if (const uint32_t start = setup.getInitialState(); start != Setup::noState) {
+        startSet[start >> 6] |= uint64_t{1} << (start & 63);
+    }
+    acceptSet.assign(wordCount, 0);
+    for (uint32_t state = 0; state < stateCount; ++state) {
+        if (setup.getFinalStates()[state]) {
+            acceptSet[state >> 6] |= uint64_t{1} << (state & 63);
+        }
+    }
+}
+
+bool NFASimulator::step(const uint64_t *active, const unsigned char symbol, uint64_t *next) const {
+    const uint32_t *row = offsets.data() + classMap[symbol] * stateCount;
+    std::fill(next, next + wordCount, 0);
+
+    bool any = false;
+    for (size_t i = 0; i < wordCount; ++i) {
+        for (uint64_t word = active[i]; word != 0; word &= word - 1) {
+            const size_t state = i * 64 + std::countr_zero(word);
+            for (uint32_t edge = row[state]; edge < row[state + 1]; ++edge) {
+                const uint32_t target = targets[edge];
+                next[target >> 6] |= uint64_t{1} << (target & 63);
+                any = true;
+            }
+        }
+    }
+    return any;
+}
+
+bool NFASimulator::isAccepting(const uint64_t *active) const {
+    for (size_t i = 0; i < wordCount; ++i) {
+        if (active[i] & acceptSet[i]) return true;
+    }
+    return false;
+}
+
+size_t NFASimulator::run(const std::string_view text, const bool longest, std::vector<uint64_t> &current,
+                         std::vector<uint64_t> &next) const {
+    current.assign(startSet.begin(), startSet.end());
+    next.resize(wordCount);
+
+    size_t matched = longest && isAccepting(current.data()) ? 0 : std::string_view::npos;
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (!step(current.data(), static_cast<unsigned char>(text[i]), next.data())) {
+            return longest ? matched : std::string_view::npos;
+        }
+        current.swap(next);
+        if (longest && isAccepting(current.data())) {
+            matched = i + 1;
+        }
+    }
+
+    if (longest) return matched;
+    return isAccepting(current.data()) ? text.size() : std::string_view::npos;
+}
+
+bool NFASimulator::process(const std::string_view word) const {
+    std::vector<uint64_t> current, next;
+    return run(word, false, current, next) != std::string_view::npos;
+}
+
+void NFASimulator::processMany(const std::span<const std::string_view> words, uint64_t *bits) const {
+    std::vector<uint64_t> current, next;
+    for (size_t i = 0; i < words.size(); i += 64) {
+        const size_t end = std::min(words.size(), i + 64);
+        uint64_t packed = 0;
+        for (size_t j = i; j < end; ++j) {
+            packed |= static_cast<uint64_t>(run(words[j], false, current, next) != std::string_view::npos) << (j - i);
+        }
+        bits[i >> 6] = packed;
+    }
+}
+
+size_t NFASimulator::longestMatch(const std::string_view text) const {
+    std::vector<uint64_t> current, next;
+    return run(text, true, current, next);
+}
+
+std::shared_ptr<CompiledDFA> NFASimulator::determinize(const size_t maxStates) const {
+    constexpr uint32_t noTarget = UINT32_MAX;
+    const size_t k = classCount();
+
+    auto toCluster = [&](const std::vector<uint64_t> &set) {
+        StateCluster cluster(stateCount);
+        for (size_t i = 0; i < wordCount; ++i) {
+            for (uint64_t word = set[i]; word != 0; word &= word - 1) {
+                cluster.insert(static_cast<int>(i * 64 + std::countr_zero(word)));
+            }
+        }
+        return cluster;
+    };
+
+    // The empty subset is the table's dead state, so it never gets a number of its own.
+    ClusterIndex subsets;
+    const bool startsDead = std::all_of(startSet.begin(), startSet.end(), [](const uint64_t word) {
+        return word == 0;
+    });
+    if (!startsDead) {
+        subsets.insert(toCluster(startSet));
+    }
+
+    std::vector<uint32_t> rows;
+    std::vector<bool> accepting;
+    std::vector<uint64_t> current(wordCount), next(wordCount);
+    for (int index = 0; index < subsets.size(); ++index) {
+        std::fill(current.begin(), current.end(), 0);
+        subsets[index].forEach([&](const int state) {
+            current[state >> 6] |= uint64_t{1} << (state & 63);
+        });
+        accepting.push_back(isAccepting(current.data()));
+        rows.resize(rows.size() + k, noTarget);
+
+        for (size_t cls = 0; cls < k; ++cls) {
+            if (!step(current.data(), classSymbol[cls], next.data())) continue;
+
+            const auto [target, inserted] = subsets.insert(toCluster(next));
+            if (inserted && static_cast<size_t>(subsets.size()) > maxStates) {
+                return nullptr;
+            }
+            rows[index * k + cls] = static_cast<uint32_t>(target);
+        }
+    }
+
+    const auto liveStates = static_cast<uint32_t>(subsets.size());
+    auto table = std::make_shared<CompiledDFA>(liveStates, startsDead ? liveStates : 0, classMap,
+                                               static_cast<uint32_t>(k));
+    for (uint32_t state = 0; state < liveStates; ++state) {
+        for (size_t cls = 0; cls < k; ++cls) {
+            if (const uint32_t target = rows[state * k + cls]; target != noTarget) {
+                table->setTransition(state, classSymbol[cls], target);
+            }
+        }
+        if (accepting[state]) {
+            table->setAccepting(state);
+        }
+    }
+    return table;
+}
@@ -1,30 +1,15 @@
 #include "PostfixConverter.h"
+#include "RegexSyntax.h"
 
 #include <stack>
 
-bool PostfixConverter::isUnary(const char c) {
-    const std::unordered_set<char> unaryOperators = {'?', '*', '+'};
-    return unaryOperators.contains(c);
-}
-
-bool PostfixConverter::isSymbol(const char c) {
-    const std::unordered_set<char> symbols = {'+', '|', '(', ')', '?', '.', '*'};
-    return !symbols.contains(c);
-}
-
 std::string PostfixConverter::add_concat_symbols(const std::string& expression){
     std::string result;
 
     for (int i = 0; i < expression.size() - 1; i++) {
-        const char t1(expression[i]), t2(expression[i + 1]);
         result += expression[i];
-
-        if((isSymbol(expression[i]) && isSymbol(expression[i + 1]))
-             || (isSymbol(expression[i]) && expression[i + 1] == '(')
-             || (expression[i] == ')' && isSymbol(expression[i + 1]))
-             || (expression[i] == ')' && expression[i + 1] == '(')
-             || (isUnary(expression[i]) && (isSymbol(expression[i + 1]) || expression[i + 1] == '('))) {
-                result += '.';
+        if (RegexSyntax::concatenates(expression[i], expression[i + 1])) {
+            result += '.';
         }
     }
 
@@ -34,43 +19,9 @@ std::string PostfixConverter::add_concat_symbols(const std::string& expression){
 
 // Shunting Yard
 std::string PostfixConverter::to_postfix(const std::string& expression) {
-    std::unordered_map<char, int> priority {
-        {'|', 1},
-            {'.', 2},
-        {'?', 3},
-        {'+', 3},
-        {'*', 3}
-    };
     std::string result;
     std::stack<char> st;
-
-    for (char c : expression) {
-        if (c == '(') {
-            st.push(c);
-        } else if (c == ')') {
-            while (!st.empty() && st.top() != '(') {
-                result += st.top();
-                st.pop();
-            }
-            if (!st.empty()) {
-                st.pop();
-            }
-        } else if (priority.contains(c)) {
-            while (!st.empty() && priority[st.top()] >= priority[c]) {
-                result += st.top();
-                st.pop();
-            }
-            st.push(c);
-        } else {
-            result += c;
-        }
-    }
-
-    while (!st.empty()) {
-        result += st.top();
-        st.pop();
-    }
-
+    RegexSyntax::toPostfix(expression, st, [&](const char c) { result += c; });
     return result;
 }
 
@@ -1,54 +1,54 @@
 #include "RegToken.h"
 
-RegToken::RegToken(char symbol, int &i) {
-    startNode = std::make_shared<StateNode>(i++);
-    endNode = std::make_shared<StateNode>(i++);
-    startNode->appendConnection(endNode, symbol);
+RegToken::RegToken(NFAGraph &graph, const char symbol) {
+    startNode = graph.addNode();
+    endNode = graph.addNode();
+    graph.connect(startNode, endNode, symbol);
 }
 
-RegToken::RegToken(int &i, const std::shared_ptr<RegToken> &lhs, char operation, const std::shared_ptr<RegToken>&rhs) {
+RegToken::RegToken(NFAGraph &graph, const RegToken &lhs, const char operation, const RegToken &rhs) {
     switch (operation) {
         case 'x':
             break;
         case '.':
-            startNode = lhs->startNode;
-        lhs->endNode->appendConnection(rhs->startNode, '\0');
-        endNode = rhs->endNode;
+            startNode = lhs.startNode;
+        graph.connect(lhs.endNode, rhs.startNode, '\0');
+        endNode = rhs.endNode;
         break;
 
         case '|':
-            startNode = std::make_shared<StateNode>(i++);
-        endNode = std::make_shared<StateNode>(i++);
+            startNode = graph.addNode();
+        endNode = graph.addNode();
 
-        startNode->appendConnection(lhs->startNode, '\0');
-        startNode->appendConnection(rhs->startNode, '\0');
-        lhs->endNode->appendConnection(endNode, '\0');
-        rhs->endNode->appendConnection(endNode, '\0');
+        graph.connect(startNode, lhs.startNode, '\0');
+        graph.connect(startNode, rhs.startNode, '\0');
+        graph.connect(lhs.endNode, endNode, '\0');
+        graph.connect(rhs.endNode, endNode, '\0');
         break;
 
         case '*':
-            startNode = std::make_shared<StateNode>(i++);
-        endNode = std::make_shared<StateNode>(i++);
+            startNode = graph.addNode();
+        endNode = graph.addNode();
 
-        startNode->appendConnection(lhs->startNode, '\0');
-        lhs->endNode->appendConnection(lhs->startNode, '\0');
-        lhs->endNode->appendConnection(endNode, '\0');
-        startNode->appendConnection(endNode, '\0');
+        graph.connect(startNode, lhs.startNode, '\0');
+        graph.connect(lhs.endNode, lhs.startNode, '\0');
+        graph.connect(lhs.endNode, endNode, '\0');
+        graph.connect(startNode, endNode, '\0');
         break;
 
         case '?':
-            startNode = std::make_shared<StateNode>(i++);
-        endNode = std::make_shared<StateNode>(i++);
+            startNode = graph.addNode();
+        endNode = graph.addNode();
 
-        startNode->appendConnection(lhs->startNode, '\0');
-        lhs->endNode->appendConnection(endNode, '\0');
-        startNode->appendConnection(endNode, '\0');
+        graph.connect(startNode, lhs.startNode, '\0');
+        graph.connect(lhs.endNode, endNode, '\0');
+        graph.connect(startNode, endNode, '\0');
         break;
 
         case '+':
-            startNode = lhs->startNode;
-        endNode = lhs->endNode;
-        endNode->appendConnection(startNode, '\0');
+            startNode = lhs.startNode;
+        endNode = lhs.endNode;
+        graph.connect(endNode, startNode, '\0');
         break;
 
         default:
@@ -56,29 +56,28 @@ RegToken::RegToken(int &i, const std::shared_ptr<RegToken> &lhs, char operation,
     }
 }
 
-std::shared_ptr<RegToken> RegToken::getENFAToken(const std::string& postfix, int& nodesCount) {
-    std::stack<std::shared_ptr<RegToken>> current_tokens;
+RegToken RegToken::getENFAToken(const std::string& postfix, NFAGraph& graph) {
+    std::stack<RegToken> current_tokens;
 
     for (char c : postfix) {
         if (isOperator(c)) {
-            std::shared_ptr<RegToken> rhs = nullptr;
-            std::shared_ptr<RegToken> lhs = current_tokens.top();
+            const size_t operands = isBinary(c) ? 2 : 1;
+            if (current_tokens.size() < operands) {
+                throw std::runtime_error("Postfix expression is wrong");
+            }
+
+            RegToken rhs;
+            RegToken lhs = current_tokens.top();
             current_tokens.pop();
 
             if (isBinary(c)) {
                 rhs = lhs;
                 lhs = current_tokens.top();
                 current_tokens.pop();
-
-                auto newToken = std::make_shared<RegToken>(nodesCount, lhs, c, rhs);
-                current_tokens.push(newToken);
-            } else {
-                auto newToken = std::make_shared<RegToken>(nodesCount, lhs, c, nullptr);
-                current_tokens.push(newToken);
             }
+            current_tokens.emplace(graph, lhs, c, rhs);
         } else {
-            auto newToken = std::make_shared<RegToken>(c, nodesCount);
-            current_tokens.push(newToken);
+            current_tokens.emplace(graph, c);
         }
     }
 
@@ -86,5 +85,6 @@ std::shared_ptr<RegToken> RegToken::getENFAToken(const std::string& postfix, int
         throw std::runtime_error("Postfix expression is wrong");
     }
 
+    graph.finalize();
     return current_tokens.top();
-}
\ No newline at end of file
+}
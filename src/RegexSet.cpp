@@ -0,0 +1,66 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include "RegexSet.h"
+#include "FiniteAutomaton.h"
+#include "RegToken.h"
+
+int RegexSet::add(const std::string &postfix) {
+    patterns.push_back(postfix);
+    dfa = nullptr;
+    return static_cast<int>(patterns.size()) - 1;
+}
+
+void RegexSet::compile() {
+    NFAGraph graph;
+    const int start = graph.addNode();
+
+    std::vector<int> endNodes;
+    for (const auto &postfix: patterns) {
+        const RegToken token = RegToken::getENFAToken(postfix, graph);
+        graph.connect(start, token.startNode);
+        endNodes.push_back(token.endNode);
+    }
+    graph.finalize();
+
+    std::vector<char> sigma_vec;
+    for (int node = 0; node < graph.size(); ++node) {
+        for (const auto &[target, symbol]: graph.connections(node)) {
+            if (symbol != '\0') sigma_vec.push_back(symbol);
+        }
+    }
+    std::sort(sigma_vec.begin(), sigma_vec.end());
+    sigma_vec.erase(std::unique(sigma_vec.begin(), sigma_vec.end()), sigma_vec.end());
+
+    const DeterminizedNFA subsets = FiniteAutomaton::determinize(graph, start, sigma_vec);
+    const auto stateCount = static_cast<uint32_t>(subsets.transitions.size());
+
+    auto table = std::make_shared<CompiledDFA>(stateCount, 0);
+    matchesByState.assign(stateCount + 1, {});
+    for (uint32_t state = 0; state < stateCount; ++state) {
+        for (size_t j = 0; j < sigma_vec.size(); ++j) {
+            if (const int to = subsets.transitions[state][j]; to != -1) {
+                table->setTransition(state, static_cast<unsigned char>(sigma_vec[j]), static_cast<uint32_t>(to));
+            }
+        }
+
+        for (size_t id = 0; id < endNodes.size(); ++id) {
+            if (subsets.clusters[static_cast<int>(state)].contains(endNodes[id])) {
+                matchesByState[state].push_back(static_cast<int>(id));
+            }
+        }
+        if (!matchesByState[state].empty()) {
+            table->setAccepting(state);
+        }
+    }
+
+    table->compressAlphabet();
+    dfa = std::move(table);
+}
+
+std::vector<int> RegexSet::matches(const std::string_view word) const {
+    if (!dfa) {
+        throw std::runtime_error("RegexSet::compile() must be called before matching");
+    }
+    return matchesByState[dfa->finalState(word)];
+}
@@ -1,49 +1,439 @@
-#include <fstream>
-#include <iostream>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <limits>
 #include <stdexcept>
 
+#ifdef _WIN32
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 #include "Setup.h"
 #include "UserWarn.h"
 
+// Read prefetch hint; compiles to nothing where __builtin_prefetch is unavailable.
+#if defined(__GNUC__) || defined(__clang__)
+#define REGEXLFA_PREFETCH(address) __builtin_prefetch(address)
+#else
+#define REGEXLFA_PREFETCH(address) ((void) (address))
+#endif
+
+namespace {
+    enum class Section { None, Sigma, States, Transitions };
+
+    constexpr uint64_t byteOnes = 0x0101010101010101;
+    constexpr uint64_t byteLows = 0x7f7f7f7f7f7f7f7f;
+
+    // Eight bytes from `p`, the first of them in the low byte.
+    uint64_t loadWord(const char *p) {
+        uint64_t word;
+        std::memcpy(&word, p, 8);
+        if constexpr (std::endian::native == std::endian::big) {
+            uint64_t swapped = 0;
+            for (int i = 0; i < 8; ++i) {
+                swapped |= (word >> 8 * i & 0xff) << 8 * (7 - i);
+            }
+            word = swapped;
+        }
+        return word;
+    }
+
+    // The high bit of every byte of `word` equal to `c`. Exact: the low seven bits are
+    // added separately, so no carry crosses into the next byte.
+    uint64_t bytesEqual(const uint64_t word, const unsigned char c) {
+        const uint64_t x = word ^ byteOnes * c;
+        return ~(((x & byteLows) + byteLows) | x | byteLows);
+    }
+
+    // First `c` in [begin, end), or end; eight bytes at a time.
+    const char *findByte(const char *begin, const char *const end, const char c) {
+        for (; end - begin >= 8; begin += 8) {
+            if (const uint64_t found = bytesEqual(loadWord(begin), c); found != 0) {
+                return begin + std::countr_zero(found) / 8;
+            }
+        }
+        while (begin < end && *begin != c) ++begin;
+        return begin;
+    }
+
+    std::string_view trim(const char *begin, const char *end) {
+        while (begin < end && *begin == ' ') ++begin;
+        while (end > begin && end[-1] == ' ') --end;
+        return {begin, static_cast<size_t>(end - begin)};
+    }
+
+    // Calls action(token) for every comma-separated, space-trimmed token of the line,
+    // splitting like std::getline(line, token, ',').
+    template<typename Action>
+    void forEachToken(const std::string_view line, Action action) {
+        const char *begin = line.data();
+        const char *const end = begin + line.size();
+        while (begin < end) {
+            const char *comma = findByte(begin, end, ',');
+            action(trim(begin, comma));
+            if (comma == end) break;
+            begin = comma + 1;
+        }
+    }
+
+    // Calls action(section, line) for every line that belongs to a section, in file order.
+    template<typename Action>
+    void forEachLine(const std::string_view text, Action action) {
+        Section section = Section::None;
+        const char *begin = text.data();
+        const char *const end = begin + text.size();
+        while (begin < end) {
+            // One scan, eight bytes at a time, finds the end of the line and whether it can
+            // hold a section header: every header word contains an S, a T or an E, and most
+            // lines have none.
+            const char *newline = begin;
+            uint64_t letters = 0;
+            bool foundNewline = false;
+            for (; end - newline >= 8; newline += 8) {
+                const uint64_t word = loadWord(newline);
+                const uint64_t wordLetters = bytesEqual(word, 'S') | bytesEqual(word, 'T') | bytesEqual(word, 'E');
+                if (const uint64_t breaks = bytesEqual(word, '\n'); breaks != 0) {
+                    // Only the letters before the newline belong to this line.
+                    letters |= wordLetters & ((breaks & (~breaks + 1)) - 1);
+                    newline += std::countr_zero(breaks) / 8;
+                    foundNewline = true;
+                    break;
+                }
+                letters |= wordLetters;
+            }
+            for (; !foundNewline && newline < end && *newline != '\n'; ++newline) {
+                letters |= *newline == 'S' || *newline == 'T' || *newline == 'E';
+            }
+            const bool headerLetter = letters != 0;
+            const std::string_view line(begin, static_cast<size_t>(newline - begin));
+            begin = newline == end ? end : newline + 1;
+
+            if (headerLetter && line.find("Sigma") != std::string_view::npos) {
+                section = Section::Sigma;
+            } else if (headerLetter && line.find("States") != std::string_view::npos) {
+                section = Section::States;
+            } else if (headerLetter && line.find("Transitions") != std::string_view::npos) {
+                section = Section::Transitions;
+            } else if (headerLetter && line.find("End") != std::string_view::npos) {
+                section = Section::None;
+            } else if (!line.empty() && line[0] != '#' && section != Section::None) {
+                action(section, line);
+            }
+        }
+    }
+
+    // FNV-1a with a final mix, so both the low bits (slot) and the high bits (tag) vary.
+    uint64_t hashName(const std::string_view name) {
+        uint64_t hash = 0xcbf29ce484222325;
+        for (const char c: name) {
+            hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001b3;
+        }
+        hash ^= hash >> 32;
+        hash *= 0xd6e8feb86659fd93;
+        return hash ^ hash >> 32;
+    }
+
+    // Open-addressing map from state name to dense id, in first-seen order. Slots keep the
+    // full hash next to the id, and the names live in one arena, so a lookup touches two
+    // compact arrays instead of chasing hash nodes and the mapped file.
+    class NameTable {
+        // Upper 32 bits: hash tag; lower 32 bits: id + 1 (0 marks an empty slot).
+        std::vector<uint64_t> slots;
+        std::string arena;
+        std::vector<uint32_t> offsets{0};
+
+        static uint32_t tagOf(const uint64_t hash) { return static_cast<uint32_t>(hash >> 32); }
+
+        void place(const uint64_t hash, const uint64_t entry) {
+            size_t slot = hash & (slots.size() - 1);
+            while (slots[slot] != 0) slot = (slot + 1) & (slots.size() - 1);
+            slots[slot] = entry;
+        }
+
+        void grow() {
+            const std::vector<uint64_t> old = std::move(slots);
+            slots.assign(old.empty() ? 1024 : old.size() * 2, 0);
+            for (const uint64_t entry: old) {
+                if (entry != 0) {
+                    place(hashName(get(static_cast<uint32_t>(entry) - 1)), entry);
+                }
+            }
+        }
+
+    public:
+        void prefetch(const uint64_t hash) const {
+            if (!slots.empty()) REGEXLFA_PREFETCH(&slots[hash & (slots.size() - 1)]);
+        }
+
+        // Id of `name` (whose hash is `hash`); `inserted` tells whether it was seen for the first time.
+        uint32_t intern(const std::string_view name, const uint64_t hash, bool &inserted) {
+            if (2 * (size() + 1) > slots.size()) grow();
+
+            const uint32_t tag = tagOf(hash);
+            size_t slot = hash & (slots.size() - 1);
+            for (; slots[slot] != 0; slot = (slot + 1) & (slots.size() - 1)) {
+                const auto id = static_cast<uint32_t>(slots[slot]) - 1;
+                if (tagOf(slots[slot]) == tag && get(id) == name) {
+                    inserted = false;
+                    return id;
+                }
+            }
+
+            inserted = true;
+            if (arena.size() + name.size() > std::numeric_limits<uint32_t>::max()) {
+                throw std::runtime_error("Too many state names in definition");
+            }
+            arena.append(name);
+            offsets.push_back(static_cast<uint32_t>(arena.size()));
+            slots[slot] = static_cast<uint64_t>(tag) << 32 | size();
+            return static_cast<uint32_t>(size() - 1);
+        }
+
+        [[nodiscard]] std::string_view get(const uint32_t id) const {
+            return {arena.data() + offsets[id], offsets[id + 1] - offsets[id]};
+        }
+
+        [[nodiscard]] size_t size() const { return offsets.size() - 1; }
+    };
+
+    std::string_view transitionLine(const std::string_view text, const size_t index) {
+        std::string_view found;
+        size_t seen = 0;
+        forEachLine(text, [&](const Section section, const std::string_view line) {
+            if (section == Section::Transitions && seen++ == index) {
+                found = line;
+            }
+        });
+        return found;
+    }
+}
 
-Setup::Setup(const std::string& file) {
-    std::ifstream f(file);
+Setup::Setup(const std::string &file) {
+#ifdef _WIN32
+    std::ifstream f(file, std::ios::binary | std::ios::ate);
     if (!f.is_open()) {
         throw std::runtime_error("Provided file does not exist: " + file);
     }
 
-    std::string line;
-    bool readSigma = false, readStates = false, readTransitions = false;
+    std::string text(static_cast<size_t>(f.tellg()), '\0');
+    f.seekg(0);
+    f.read(text.data(), static_cast<std::streamsize>(text.size()));
+    parse(text);
+#else
+    const int fd = open(file.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Provided file does not exist: " + file);
+    }
+
+    struct stat info{};
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        throw std::runtime_error("Could not stat file: " + file);
+    }
+
+    const auto size = static_cast<size_t>(info.st_size);
+    if (size == 0) {
+        close(fd);
+        parse({});
+        return;
+    }
+
+#ifdef MAP_POPULATE
+    // Every page is read exactly once; fault them in with the mapping instead of one by one.
+    constexpr int mapFlags = MAP_PRIVATE | MAP_POPULATE;
+#else
+    constexpr int mapFlags = MAP_PRIVATE;
+#endif
+    void *data = mmap(nullptr, size, PROT_READ, mapFlags, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        throw std::runtime_error("Could not map file: " + file);
+    }
+
+    madvise(data, size, MADV_SEQUENTIAL);
+    try {
+        parse(std::string_view(static_cast<const char *>(data), size));
+    } catch (...) {
+        munmap(data, size);
+        throw;
+    }
+    munmap(data, size);
+#endif
+}
+
+Setup Setup::fromText(const std::string_view text) {
+    Setup setup;
+    setup.parse(text);
+    return setup;
+}
 
-    while (std::getline(f, line)) {
-        if (line.find("Sigma") != std::string::npos) {
-            readSigma = true;
-            readStates = readTransitions = false;
-        } else if (line.find("States") != std::string::npos) {
-            readStates = true;
-            readSigma = readTransitions = false;
-        } else if (line.find("Transitions") != std::string::npos) {
-            readTransitions = true;
-            readSigma = readStates = false;
-        } else if (line.find("End") != std::string::npos) {
-            readSigma = readStates = readTransitions = false;
-        } else if (line.starts_with("#") || line.empty()) {
-            continue;
-        } else {
-            if (readSigma) {
-                sigma.push_back(line);
-            } else if (readStates) {
-                states.push_back(line);
-            } else if (readTransitions) {
-                transitions.push_back(line);
+void Setup::parse(const std::string_view text) {
+    // Ids are handed out on first sight, so a transition may name a state before the
+    // States section declares it.
+    size_t lines = 1;
+    for (const char *newline = text.data(), *const end = newline + text.size();
+         (newline = findByte(newline, end, '\n')) != end; ++newline) {
+        ++lines;
+    }
+    transitions.reserve(lines);
+    NameTable names;
+    std::vector<bool> declared;
+    std::vector<uint32_t> declarationOrder;
+    std::vector<bool> finals;
+    bool hasInitialState = false, hasFinalState = false;
+
+    auto intern = [&](const std::string_view name, const uint64_t hash) {
+        bool inserted = false;
+        const uint32_t id = names.intern(name, hash, inserted);
+        if (inserted) {
+            declared.push_back(false);
+            finals.push_back(false);
+        }
+        return id;
+    };
+
+    struct PendingName {
+        uint64_t hash;
+        std::string_view name;
+    };
+    std::vector<PendingName> targets;
+    targets.reserve(lines);
+
+    // Transitions are usually grouped by their source state.
+    std::string_view lastFrom;
+    uint32_t lastFromId = noState;
+
+    forEachLine(text, [&](const Section section, const std::string_view line) {
+        if (section == Section::Sigma) {
+            sigma.push_back(line[0]);
+            return;
+        }
+
+        if (section == Section::States) {
+            std::string_view name;
+            bool initial = false, final = false;
+            forEachToken(line, [&](const std::string_view token) {
+                if (token == "S") {
+                    if (hasInitialState) {
+                        UserWarn("Initial state should be unique", std::string(line));
+                    }
+                    hasInitialState = initial = true;
+                } else if (token == "F") {
+                    hasFinalState = final = true;
+                } else {
+                    name = token;
+                }
+            });
+
+            if (name.empty()) {
+                UserWarn("State must have a name", std::string(line));
+            }
+
+            const uint32_t id = intern(name, hashName(name));
+            if (declared[id]) {
+                UserWarn("State names should be unique", std::string(line));
+            }
+            declared[id] = true;
+            finals[id] = final;
+            declarationOrder.push_back(id);
+            if (initial) {
+                initialState = id;
             }
+            return;
         }
+
+        std::string_view from, to;
+        char symbol = '\0';
+        int tokenCount = 0;
+        forEachToken(line, [&](const std::string_view token) {
+            switch (tokenCount++) {
+                case 0: from = token;
+                    break;
+                case 1: if (token.length() > 1) UserWarn("The symbol should be an unique character", std::string(line));
+                    symbol = token.empty() ? '\0' : token[0];
+                    break;
+                case 2: to = token;
+                    break;
+                default: break;
+            }
+        });
+        if (lastFromId == noState || from != lastFrom) {
+            lastFrom = from;
+            lastFromId = intern(from, hashName(from));
+        }
+        transitions.push_back({lastFromId, 0, symbol});
+        targets.push_back({hashName(to), to});
+    });
+
+    // Targets are looked up in a second pass, with the slot of a later target prefetched
+    // while the current one is resolved: a lookup then rarely waits on a cache miss.
+    constexpr size_t prefetchDistance = 8;
+    for (size_t i = 0; i < targets.size(); ++i) {
+        if (i + prefetchDistance < targets.size()) {
+            names.prefetch(targets[i + prefetchDistance].hash);
+        }
+        transitions[i].to = intern(targets[i].name, targets[i].hash);
+    }
+
+    if (declarationOrder.empty()) {
+        UserWarn("There are no states declared for this DFA");
+    }
+    if (!hasFinalState) {
+        UserWarn("At least one final state required");
     }
 
-    f.close();
+    std::array<bool, 256> inSigma{};
+    for (const char c: sigma) {
+        inSigma[static_cast<unsigned char>(c)] = true;
+    }
+    for (size_t i = 0; i < transitions.size(); ++i) {
+        const auto &[from, to, symbol] = transitions[i];
+        if (!inSigma[static_cast<unsigned char>(symbol)]) {
+            UserWarn("The symbol is not defined in Sigma");
+        }
+        if (!declared[from] || !declared[to]) {
+            UserWarn("There are undefined states", std::string(transitionLine(text, i)));
+        }
+    }
+
+    // Every id is declared by now. Renumber only if a transition named a state before
+    // its declaration, so ids follow declaration order.
+    bool inDeclarationOrder = true;
+    for (uint32_t i = 0; i < declarationOrder.size(); ++i) {
+        inDeclarationOrder = inDeclarationOrder && declarationOrder[i] == i;
+    }
+    std::vector<uint32_t> renumbered;
+    if (!inDeclarationOrder) {
+        renumbered.assign(names.size(), 0);
+        for (uint32_t i = 0; i < declarationOrder.size(); ++i) {
+            renumbered[declarationOrder[i]] = i;
+        }
+    }
+    if (!renumbered.empty()) {
+        for (auto &transition: transitions) {
+            transition.from = renumbered[transition.from];
+            transition.to = renumbered[transition.to];
+        }
+        if (initialState != noState) {
+            initialState = renumbered[initialState];
+        }
+    }
+
+    states.reserve(declarationOrder.size());
+    finalStates.reserve(declarationOrder.size());
+    for (const uint32_t id: declarationOrder) {
+        states.emplace_back(names.get(id));
+        finalStates.push_back(finals[id]);
+    }
 }
 
-[[nodiscard]] const std::vector<std::string>& Setup::getSigma() const {
+[[nodiscard]] const std::vector<char>& Setup::getSigma() const {
     return sigma;
 }
 
@@ -51,6 +441,14 @@ Setup::Setup(const std::string& file) {
     return states;
 }
 
-[[nodiscard]] const std::vector<std::string>& Setup::getTransitions() const {
+[[nodiscard]] const std::vector<bool>& Setup::getFinalStates() const {
+    return finalStates;
+}
+
+[[nodiscard]] uint32_t Setup::getInitialState() const {
+    return initialState;
+}
+
+[[nodiscard]] const std::vector<Setup::Transition>& Setup::getTransitions() const {
     return transitions;
-}
\ No newline at end of file
+}
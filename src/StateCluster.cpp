@@ -1,28 +1,83 @@
 #include "StateCluster.h"
 
-StateCluster StateCluster::stepWith(const char symbol, const std::vector<std::shared_ptr<StateNode>>& id_map) const {
-    std::vector<std::shared_ptr<StateNode>> result;
+uint64_t StateCluster::computeHash() const {
+    uint64_t h = 0x9e3779b97f4a7c15ULL ^ words.size();
+    for (const uint64_t word : words) {
+        h ^= word + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h;
+}
+
+StateCluster StateCluster::stepWith(const char symbol, const NFAGraph& graph) const {
+    StateCluster result(graph.size());
 
-    for (const int id : state_ids) {
-        for (auto& node = id_map[id]; const auto& [target, transition_symbol] : node->connections) {
+    forEach([&](const int id) {
+        for (const auto& [target, transition_symbol] : graph.connections(id)) {
             if (transition_symbol == symbol) {
-                result.push_back(target);
+                result.insert(target);
             }
         }
-    }
+    });
 
-    return StateCluster(result);
+    return result;
 }
 
 std::string StateCluster::toString() const {
     std::ostringstream oss;
     oss << "{";
     bool first = true;
-    for (const auto& state : states) {
+    forEach([&](const int id) {
         if (!first) oss << ",";
-        oss << state->toString();
+        oss << NFAGraph::toString(id);
         first = false;
-    }
+    });
     oss << "}";
     return oss.str();
-}
\ No newline at end of file
+}
+
+void ClusterIndex::grow() {
+    std::vector<int> larger(slots.size() * 2, -1);
+    const size_t mask = larger.size() - 1;
+    for (int index = 0; index < size(); ++index) {
+        size_t slot = clusters[index].hash() & mask;
+        while (larger[slot] != -1) {
+            slot = (slot + 1) & mask;
+        }
+        larger[slot] = index;
+    }
+    slots = std::move(larger);
+}
+
+std::pair<int, bool> ClusterIndex::insert(const StateCluster& cluster) {
+    if ((clusters.size() + 1) * 4 > slots.size() * 3) {
+        grow();
+    }
+
+    const size_t mask = slots.size() - 1;
+    size_t slot = cluster.hash() & mask;
+    while (slots[slot] != -1) {
+        if (clusters[slots[slot]] == cluster) {
+            return {slots[slot], false};
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    slots[slot] = size();
+    clusters.push_back(cluster);
+    return {slots[slot], true};
+}
+
+int ClusterIndex::find(const StateCluster& cluster) const {
+    const size_t mask = slots.size() - 1;
+    size_t slot = cluster.hash() & mask;
+    while (slots[slot] != -1) {
+        if (clusters[slots[slot]] == cluster) {
+            return slots[slot];
+        }
+        slot = (slot + 1) & mask;
+    }
+    return -1;
+}
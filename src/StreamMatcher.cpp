@@ -0,0 +1,91 @@
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "StreamMatcher.h"
+
+StreamMatcher::StreamMatcher(std::shared_ptr<const CompiledDFA> dfa) : dfa(std::move(dfa)) {
+    reset();
+}
+
+StreamMatcher::StreamMatcher(std::shared_ptr<const GlushkovMatcher> bitParallel)
+    : bitParallel(std::move(bitParallel)) {
+    reset();
+}
+
+void StreamMatcher::reset() {
+    state = dfa ? dfa->getStartState() : GlushkovMatcher::initialState();
+}
+
+void StreamMatcher::feed(const std::string_view chunk) {
+    if (dfa) {
+        const uint32_t dead = dfa->getDeadState();
+        auto current = static_cast<uint32_t>(state);
+        for (size_t i = 0; i < chunk.size() && current != dead; ++i) {
+            current = dfa->next(current, static_cast<unsigned char>(chunk[i]));
+        }
+        state = current;
+    } else {
+        uint64_t active = state;
+        for (size_t i = 0; i < chunk.size() && active != 0; ++i) {
+            active = bitParallel->step(active, static_cast<unsigned char>(chunk[i]));
+        }
+        state = active;
+    }
+}
+
+bool StreamMatcher::finish() {
+    const bool accepted = dfa ? dfa->isAccepting(static_cast<uint32_t>(state)) : bitParallel->isAccepting(state);
+    reset();
+    return accepted;
+}
+
+#ifdef _WIN32
+void StreamMatcher::feedFile(const std::string &path) {
+    std::ifstream f(path, std::ios::binary);
+    if (!f.is_open()) {
+        throw std::runtime_error("Provided file does not exist: " + path);
+    }
+
+    char buffer[1 << 16];
+    while (f.read(buffer, sizeof(buffer)) || f.gcount() > 0) {
+        feed(std::string_view(buffer, static_cast<size_t>(f.gcount())));
+    }
+}
+#else
+void StreamMatcher::feedFile(const std::string &path) {
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Provided file does not exist: " + path);
+    }
+
+    struct stat info{};
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        throw std::runtime_error("Could not stat file: " + path);
+    }
+
+    const auto size = static_cast<size_t>(info.st_size);
+    if (size == 0) {
+        close(fd);
+        return;
+    }
+
+    void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        throw std::runtime_error("Could not map file: " + path);
+    }
+
+    madvise(data, size, MADV_SEQUENTIAL);
+    feed(std::string_view(static_cast<const char *>(data), size));
+    munmap(data, size);
+}
+#endif
@@ -1,7 +1,125 @@
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
 #include <format>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
 
 #include "Tester.h"
 #include "FiniteAutomaton.h"
+#include "ThreadPool.h"
+
+namespace {
+    // SAX handler for a test file, an array of {name, regex, test_strings: [{input, expected}]}.
+    // Every complete entry is handed to onTest as soon as its object closes; other keys are skipped.
+    class TestReader final : public json::json_sax_t {
+        const std::string &filename;
+        const std::function<void(std::string, Test)> &onTest;
+
+        // Open arrays and objects: 1 inside the top-level array, 2 inside an entry,
+        // 3 inside its test_strings, 4 inside a test case.
+        size_t depth = 0;
+        std::string entryKey;
+        std::string caseKey;
+        bool inTestStrings = false;
+
+        std::string name;
+        Test test;
+        bool hasName = false;
+        bool hasRegex = false;
+        std::string input;
+        bool expected = false;
+        bool hasInput = false;
+        bool hasExpected = false;
+
+    public:
+        TestReader(const std::string &filename, const std::function<void(std::string, Test)> &onTest)
+            : filename(filename), onTest(onTest) {}
+
+        bool null() override { return true; }
+        bool number_integer(number_integer_t) override { return true; }
+        bool number_unsigned(number_unsigned_t) override { return true; }
+        bool number_float(number_float_t, const string_t &) override { return true; }
+        bool binary(binary_t &) override { return true; }
+
+        bool boolean(const bool value) override {
+            if (depth == 4 && caseKey == "expected") {
+                expected = value;
+                hasExpected = true;
+            }
+            return true;
+        }
+
+        bool string(string_t &value) override {
+            if (depth == 2 && entryKey == "name") {
+                name = std::move(value);
+                hasName = true;
+            } else if (depth == 2 && entryKey == "regex") {
+                test.regex = std::move(value);
+                hasRegex = true;
+            } else if (depth == 4 && caseKey == "input") {
+                input = std::move(value);
+                hasInput = true;
+            }
+            return true;
+        }
+
+        bool key(string_t &value) override {
+            if (depth == 2) entryKey = std::move(value);
+            else if (depth == 4) caseKey = std::move(value);
+            return true;
+        }
+
+        bool start_object(std::size_t) override {
+            if (depth == 1) {
+                name.clear();
+                test = Test();
+                hasName = hasRegex = false;
+            } else if (depth == 3 && inTestStrings) {
+                hasInput = hasExpected = false;
+            }
+            ++depth;
+            return true;
+        }
+
+        bool end_object() override {
+            --depth;
+            if (depth == 3 && inTestStrings && hasInput && hasExpected) {
+                test.test_strings.emplace_back(std::move(input), expected);
+            } else if (depth == 1) {
+                if (hasName && hasRegex) {
+                    onTest(std::move(name), std::move(test));
+                } else {
+                    std::cerr << "Error: Skipping a test without a name or regex in " << filename << std::endl;
+                }
+            }
+            return true;
+        }
+
+        bool start_array(std::size_t) override {
+            if (depth == 2) {
+                inTestStrings = entryKey == "test_strings";
+            }
+            ++depth;
+            return true;
+        }
+
+        bool end_array() override {
+            if (--depth == 2) {
+                inTestStrings = false;
+            }
+            return true;
+        }
+
+        bool parse_error(std::size_t, const std::string &, const nlohmann::detail::exception &ex) override {
+            std::cerr << "Error: Could not parse file " << filename << ": " << ex.what() << std::endl;
+            return false;
+        }
+    };
+}
 
 void Tester::makeTests(const std::string &filename) {
     std::ifstream file(filename);
@@ -22,51 +140,215 @@ void Tester::makeTests(const std::string &filename) {
             test.test_strings.emplace_back(test_case["input"], test_case["expected"]);
         }
 
-        tests[entry["name"]] = test;
+        const std::string name = entry["name"];
+        tests[name] = std::move(test);
+        positions[name] = entriesRead++;
     }
 }
 
 void Tester::init() {
-    const std::string testDirectory = getTestDirectory();
-    for (const auto &entry: fs::directory_iterator(testDirectory)) {
+    std::vector<std::string> files;
+    for (const auto &entry: fs::directory_iterator(getTestDirectory())) {
         if (entry.is_regular_file()) {
-            std::string filename = entry.path().string();
-            makeTests(filename);
+            files.push_back(entry.path().string());
         }
     }
+    std::sort(files.begin(), files.end());
+    for (const auto &filename: files) {
+        makeTests(filename);
+    }
+}
+
+std::string Tester::runTest(const std::string &name, const Test &test, const bool verbose) {
+    std::ostringstream os;
+    os << std::string(80, '_') << '\n';
+
+    try {
+        std::string postfix = PostfixConverter::getPostfix(test.regex);
+
+        os << "Test name: " << name << std::endl;
+        os << "Regex: " << test.regex << std::endl;
+        os << std::format("\033[34mPostfix: {}", postfix) << std::endl;
+
+        CompileOptions options;
+        if (verbose) {
+            // The state map only exists for the State-graph engine.
+            options.engine = MatchEngine::DFA;
+            options.log = &os;
+        }
+        const std::unique_ptr<const FiniteAutomaton> regexParser(FiniteAutomaton::buildFromRegex(postfix, options));
+        if (verbose) {
+            os << *regexParser;
+        }
+
+        os << "\033[0m";
+
+        for (const auto &[input, expected]: test.test_strings) {
+            if (const auto result = regexParser->process(input); result == expected) {
+                os << std::format("\033[32mInput: {} | Expected: {} | Result: {} \033[0m", input,
+                                  (expected ? "true" : "false"), (result ? "true" : "false")) << std::endl;
+            } else {
+                os << std::format("\033[31mInput: {} | Expected: {} | Result: {} \033[0m", input,
+                                  (expected ? "true" : "false"), (result ? "true" : "false")) << std::endl;
+            }
+        }
+    } catch (const std::exception &e) {
+        os << std::format("\033[31mTest {} failed to compile: {} \033[0m", name, e.what()) << std::endl;
+    }
+
+    os << std::endl;
+    return os.str();
 }
 
 void Tester::run() {
     if (this->tests.empty()) {
         std::cerr << "There are no tests. Use Tester::init() before run." << std::endl;
     } else {
-        for (const auto &[name, test]: this->tests) {
-            std::cout << std::string(80, '_') << '\n';
-            std::string postfix = PostfixConverter::getPostfix(test.regex);
+        // Tests are compiled and evaluated on the pool; output is buffered per test
+        // and printed in file and entry order once everything has finished.
+        std::vector<const std::pair<const std::string, Test> *> ordered;
+        ordered.reserve(this->tests.size());
+        for (const auto &entry: this->tests) {
+            ordered.push_back(&entry);
+        }
+        std::sort(ordered.begin(), ordered.end(), [&](const auto *lhs, const auto *rhs) {
+            return positions.at(lhs->first) < positions.at(rhs->first);
+        });
 
-            std::cout << "Test name: " << name << std::endl;
-            std::cout << "Regex: " << test.regex << std::endl;
-            std::cout << std::format("\033[34mPostfix: {}", postfix) << std::endl;
+        std::vector<std::string> outputs(ordered.size());
+        {
+            ThreadPool pool;
+            for (size_t i = 0; i < ordered.size(); ++i) {
+                pool.submit([&, i] {
+                    outputs[i] = runTest(ordered[i]->first, ordered[i]->second, verbose);
+                });
+            }
+            pool.wait();
+        }
 
-            const FiniteAutomaton *regexParser(FiniteAutomaton::buildFromRegex(postfix));
-            std::cout << *regexParser;
+        for (const auto &output: outputs) {
+            std::cout << output;
+        }
+        std::cout.flush();
+    }
 
-            std::cout << "\033[0m";
+    clearTests();
+}
 
-            for (const auto &[input, expected]: test.test_strings) {
-                if (const auto result = regexParser->process(input); result == expected) {
-                    std::cout << std::format("\033[32mInput: {} | Expected: {} | Result: {} \033[0m", input,
-                                             (expected ? "true" : "false"), (result ? "true" : "false")) << std::endl;
-                } else {
-                    std::cout << std::format("\033[31mInput: {} | Expected: {} | Result: {} \033[0m", input,
-                                             (expected ? "true" : "false"), (result ? "true" : "false")) << std::endl;
-                }
+void Tester::stream() {
+    std::vector<std::string> files;
+    for (const auto &entry: fs::directory_iterator(getTestDirectory())) {
+        if (entry.is_regular_file()) {
+            files.push_back(entry.path().string());
+        }
+    }
+    std::sort(files.begin(), files.end());
+
+    // Tests are printed by (file index, entry index), the order of run(); a finished test
+    // waits in `finished` until every earlier one has been printed. The reader of the file
+    // being printed waits while streamWindow of its own tests are unprinted, the others
+    // while streamWindow tests are unprinted in total, so they can never starve it.
+    struct FileProgress {
+        size_t parsed = 0;
+        bool done = false;
+    };
+    std::mutex lock;
+    std::condition_variable windowOpen;
+    std::vector<FileProgress> progress(files.size());
+    size_t parsed = 0;
+    size_t printed = 0;
+    size_t headFile = 0;
+    size_t headPrinted = 0;
+    std::map<std::pair<size_t, size_t>, std::string> finished;
+    ThreadPool pool;
+
+    // Prints every test that is next in order; called with `lock` held.
+    auto drain = [&] {
+        while (headFile < files.size()) {
+            if (!finished.empty() && finished.begin()->first == std::pair(headFile, headPrinted)) {
+                std::cout << finished.begin()->second;
+                finished.erase(finished.begin());
+                ++headPrinted;
+                ++printed;
+            } else if (progress[headFile].done && headPrinted == progress[headFile].parsed) {
+                ++headFile;
+                headPrinted = 0;
+            } else {
+                break;
+            }
+        }
+        windowOpen.notify_all();
+    };
+
+    auto submit = [&](const size_t file, std::string name, Test test) {
+        size_t entry;
+        {
+            std::unique_lock guard(lock);
+            windowOpen.wait(guard, [&] {
+                return file == headFile ? progress[file].parsed - headPrinted < streamWindow
+                                        : parsed - printed < streamWindow;
+            });
+            entry = progress[file].parsed++;
+            ++parsed;
+        }
+        pool.submit([&, file, entry, name = std::move(name), test = std::move(test)] {
+            // The entry is marked finished even when the test throws, so the files behind
+            // it still drain; pool.wait() then rethrows.
+            std::string output;
+            std::exception_ptr failure;
+            try {
+                output = runTest(name, test, verbose);
+            } catch (...) {
+                failure = std::current_exception();
+            }
+
+            {
+                std::lock_guard guard(lock);
+                finished.emplace(std::pair(file, entry), std::move(output));
+                drain();
+            }
+            if (failure) {
+                std::rethrow_exception(failure);
             }
-            std::cout << std::endl;
+        });
+    };
+
+    std::atomic<size_t> nextFile = 0;
+    auto readFiles = [&] {
+        std::vector<char> buffer(size_t{1} << 20);
+        for (size_t i = nextFile++; i < files.size(); i = nextFile++) {
+            std::ifstream file;
+            file.rdbuf()->pubsetbuf(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            file.open(files[i], std::ios::binary);
+            if (file.is_open()) {
+                const std::function<void(std::string, Test)> onTest = [&, i](std::string name, Test test) {
+                    submit(i, std::move(name), std::move(test));
+                };
+                TestReader reader(files[i], onTest);
+                json::sax_parse(file, &reader);
+            } else {
+                std::cerr << "Error: Could not open file " << files[i] << std::endl;
+            }
+
+            std::lock_guard guard(lock);
+            progress[i].done = true;
+            drain();
         }
+    };
+
+    std::vector<std::thread> readers;
+    for (size_t i = 0; i < std::min(files.size(), streamReaders); ++i) {
+        readers.emplace_back(readFiles);
+    }
+    for (auto &reader: readers) {
+        reader.join();
     }
+    pool.wait();
 
-    clearTests();
+    if (parsed == 0) {
+        std::cerr << "There are no tests in " << getTestDirectory() << "." << std::endl;
+    }
+    std::cout.flush();
 }
 
 std::string Tester::getTestDirectory() {
@@ -75,4 +357,6 @@ std::string Tester::getTestDirectory() {
 
 void Tester::clearTests() {
     tests.clear();
+    positions.clear();
+    entriesRead = 0;
 }
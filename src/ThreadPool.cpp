@@ -0,0 +1,115 @@
+#include "ThreadPool.h"
+
+#include <utility>
+
+namespace {
+    // The pool whose worker runs on this thread (nullptr outside every pool), and the
+    // worker's queue index in that pool.
+    thread_local const ThreadPool *currentPool = nullptr;
+    thread_local size_t currentWorker = 0;
+}
+
+ThreadPool::ThreadPool(size_t threads) {
+    if (threads == 0) {
+        threads = 1;
+    }
+
+    for (size_t i = 0; i < threads; ++i) {
+        queues.push_back(std::make_unique<WorkQueue>());
+    }
+    for (size_t i = 0; i < threads; ++i) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard guard(wakeLock);
+        stopping = true;
+    }
+    wake.notify_all();
+
+    for (auto &worker: workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    const size_t index = currentPool == this
+                             ? currentWorker
+                             : nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+    // Counted before the push so `queued` never drops below the number of queued tasks.
+    {
+        std::lock_guard guard(wakeLock);
+        ++pending;
+        ++queued;
+    }
+    {
+        std::lock_guard guard(queues[index]->lock);
+        queues[index]->tasks.push_back(std::move(task));
+    }
+    wake.notify_one();
+}
+
+bool ThreadPool::tryPop(const size_t index, std::function<void()> &task) {
+    {
+        std::lock_guard guard(queues[index]->lock);
+        if (!queues[index]->tasks.empty()) {
+            task = std::move(queues[index]->tasks.back());
+            queues[index]->tasks.pop_back();
+            --queued;
+            return true;
+        }
+    }
+
+    for (size_t offset = 1; offset < queues.size(); ++offset) {
+        auto &victim = *queues[(index + offset) % queues.size()];
+        std::lock_guard guard(victim.lock);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            --queued;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void ThreadPool::workerLoop(const size_t index) {
+    currentPool = this;
+    currentWorker = index;
+
+    while (true) {
+        std::function<void()> task;
+        if (tryPop(index, task)) {
+            try {
+                task();
+            } catch (...) {
+                std::lock_guard guard(wakeLock);
+                if (!failure) {
+                    failure = std::current_exception();
+                }
+            }
+            if (--pending == 0) {
+                std::lock_guard guard(wakeLock);
+                idle.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock guard(wakeLock);
+        wake.wait(guard, [&] { return stopping || queued > 0; });
+        if (stopping && queued == 0) {
+            return;
+        }
+    }
+}
+
+void ThreadPool::wait() {
+    std::unique_lock guard(wakeLock);
+    idle.wait(guard, [&] { return pending == 0; });
+    if (failure) {
+        std::rethrow_exception(std::exchange(failure, nullptr));
+    }
+}
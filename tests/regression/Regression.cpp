@@ -0,0 +1,1173 @@
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <regex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "AutomatonStats.h"
+#include "CompileCache.h"
+#include "CompiledDFA.h"
+#include "FiniteAutomaton.h"
+#include "GlushkovMatcher.h"
+#include "InterleavedMatch.h"
+#include "LazyDFA.h"
+#include "LiteralMatcher.h"
+#include "NFASimulator.h"
+#include "PostfixConverter.h"
+#include "RegToken.h"
+#include "RegexSet.h"
+#include "RegressionMatchers.h"
+#include "RegressionSwitchMatchers.h"
+#include "Setup.h"
+#include "StateCluster.h"
+#include "StreamMatcher.h"
+#include "StaticRegex.h"
+#include "Tester.h"
+#include "ThreadPool.h"
+
+// Cases for bugs that the definition-file tests in tests/ cannot reach. Exits non-zero
+// when any case fails.
+namespace {
+    // A header whose tableOffset + tableBytes wraps around 2^64 to a small value, with
+    // acceptOffset and fileSize consistent with that wrapped value.
+    bool rejectsWrappedOffsets() {
+        constexpr uint32_t stateCount = 1u << 28;
+        constexpr uint32_t classCount = 16;
+        constexpr uint64_t tableBytes = uint64_t{stateCount} * classCount * sizeof(uint32_t);
+        constexpr uint64_t acceptBytes = (uint64_t{stateCount} + 63) / 64 * sizeof(uint64_t);
+
+        CompiledDFA::FileHeader header{};
+        std::memcpy(header.magic, CompiledDFA::fileMagic, sizeof(header.magic));
+        header.version = CompiledDFA::fileVersion;
+        header.byteOrder = CompiledDFA::fileByteOrder;
+        header.stateCount = stateCount;
+        header.classCount = classCount;
+        header.tableOffset = 0 - tableBytes;
+        header.acceptOffset = 320;
+        header.fileSize = header.acceptOffset + acceptBytes;
+
+        const std::string path = "regression-wrapped-offsets.bin";
+        {
+            std::ofstream out(path, std::ios::binary);
+            out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            const std::vector<char> rest(header.fileSize - sizeof(header), 0);
+            out.write(rest.data(), static_cast<std::streamsize>(rest.size()));
+        }
+
+        bool rejected = false;
+        try {
+            CompiledDFA::load(path);
+        } catch (const std::runtime_error &) {
+            rejected = true;
+        }
+        std::remove(path.c_str());
+        return rejected;
+    }
+
+    // Workers of one pool submitting to a smaller pool must not use their own queue index
+    // in the other pool.
+    bool nestedPoolsSubmit() {
+        ThreadPool outer(4);
+        ThreadPool inner(1);
+        std::atomic<int> done = 0;
+        for (int i = 0; i < 16; ++i) {
+            outer.submit([&] {
+                inner.submit([&] { done.fetch_add(1); });
+            });
+        }
+        outer.wait();
+        inner.wait();
+        return done.load() == 16;
+    }
+
+    // Tasks that submit more tasks from inside the workers: wait() returns only once the
+    // whole tree has run, and every task runs exactly once.
+    bool poolWaitsForFanOut() {
+        ThreadPool pool(3);
+        std::vector<std::atomic<int>> runs(1 + 8 + 64 + 512);
+        std::function<void(size_t, int)> spawn = [&](const size_t node, const int depth) {
+            runs[node].fetch_add(1);
+            if (depth == 3) return;
+            for (size_t child = 0; child < 8; ++child) {
+                pool.submit([&, node, depth, child] { spawn(node * 8 + child + 1, depth + 1); });
+            }
+        };
+        pool.submit([&] { spawn(0, 0); });
+        pool.wait();
+        for (const auto &count: runs) {
+            if (count.load() != 1) return false;
+        }
+        return true;
+    }
+
+    // A throwing task neither ends its worker nor stops the other tasks; wait() rethrows
+    // it once, and the pool keeps working afterwards.
+    bool poolRethrowsTaskFailure() {
+        ThreadPool pool(2);
+        std::atomic<int> done = 0;
+        for (int i = 0; i < 32; ++i) {
+            pool.submit([&, i] {
+                if (i % 8 == 3) throw std::runtime_error("task failed");
+                done.fetch_add(1);
+            });
+        }
+
+        bool rethrown = false;
+        try {
+            pool.wait();
+        } catch (const std::runtime_error &) {
+            rethrown = true;
+        }
+
+        pool.submit([&] { done.fetch_add(1); });
+        pool.wait();
+        return rethrown && done.load() == 29;
+    }
+
+    // A one-byte cache budget sends LazyDFA through its uncached fallback, which must
+    // treat a NUL byte as a symbol with no edges, not as an epsilon move.
+    bool lazyFallbackRejectsNul() {
+        CompileOptions options;
+        options.engine = MatchEngine::LazyDFA;
+        options.lazyCacheBytes = 1;
+        const std::unique_ptr<const FiniteAutomaton> fa(
+            FiniteAutomaton::buildFromRegex(PostfixConverter::getPostfix("(ab)*"), options));
+        using namespace std::string_literals;
+        return fa->process("abab") && !fa->process("ab\0"s) && !fa->process("ab\0ab"s);
+    }
+
+    // The a-words and the b-words each need more than half of the cache. Once the a-words
+    // have filled it, the b-words miss on their first byte; they must eventually flush
+    // the stale cache and then run from a warm one.
+    bool lazyCacheRecoversAfterFlush() {
+        NFAGraph graph;
+        const RegToken token = RegToken::getENFAToken(PostfixConverter::getPostfix("(aaaaaaaa)*|(bbbbbbbb)*"), graph);
+        const LazyDFA lazy(std::move(graph), token.startNode, token.endNode, 1024);
+
+        const std::string aWord(64, 'a'), bWord(64, 'b');
+        for (int i = 0; i < 100; ++i) {
+            if (!lazy.process(aWord)) return false;
+        }
+        for (int i = 0; i < 100; ++i) {
+            if (!lazy.process(bWord)) return false;
+        }
+        const size_t flushes = lazy.getFlushCount();
+        for (int i = 0; i < 100; ++i) {
+            if (!lazy.process(bWord) || lazy.process(bWord + "a")) return false;
+        }
+        return flushes > 0 && lazy.getFlushCount() == flushes;
+    }
+
+    // (a|b)*a(a|b)^7 needs 2^8 DFA states. A cache far smaller than that is flushed (or
+    // falls back to NFA simulation) again and again, but every answer stays the DFA's.
+    bool lazyMatchesFullDFAUnderPressure() {
+        const std::string postfix = PostfixConverter::getPostfix("(a|b)*a(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)");
+        NFAGraph graph;
+        const RegToken token = RegToken::getENFAToken(postfix, graph);
+        const LazyDFA lazy(std::move(graph), token.startNode, token.endNode, 2048);
+        CompileOptions options;
+        options.engine = MatchEngine::DFA;
+        const std::unique_ptr<const FiniteAutomaton> dfa(FiniteAutomaton::buildFromRegex(postfix, options));
+
+        std::mt19937 random(5);
+        for (int i = 0; i < 2000; ++i) {
+            std::string word(8 + random() % 56, 'a');
+            for (char &c: word) c = "ab"[random() % 2];
+            const size_t longest = dfa->getCompiledDFA()->longestMatch(word);
+            if (lazy.process(word) != dfa->process(word) || lazy.longestMatch(word) != longest) return false;
+        }
+        return lazy.getFlushCount() > 0;
+    }
+
+    // (a|b)* followed by a literal tail: 63 positions fill every follow-table chunk of the
+    // bit-parallel matcher, and one more sends the BitParallel engine to the DFA.
+    bool glushkovHandlesMaxPositions() {
+        std::string tail;
+        for (int i = 0; i < GlushkovMatcher::maxPositions - 2; ++i) tail += "ab"[i % 3 == 0];
+        const std::string postfix = PostfixConverter::getPostfix("(a|b)*" + tail);
+        const auto matcher = GlushkovMatcher::build(postfix);
+        CompileOptions options;
+        options.engine = MatchEngine::DFA;
+        const std::unique_ptr<const FiniteAutomaton> dfa(FiniteAutomaton::buildFromRegex(postfix, options));
+        if (!matcher || matcher->getPositionCount() != GlushkovMatcher::maxPositions) return false;
+
+        std::mt19937 random(6);
+        for (int i = 0; i < 500; ++i) {
+            std::string word(random() % 8, 'a');
+            for (char &c: word) c = "ab"[random() % 2];
+            if (i % 2 == 0) word += tail.substr(random() % 4);
+            if (matcher->process(word) != dfa->process(word)
+                || matcher->longestMatch(word) != dfa->getCompiledDFA()->longestMatch(word)) {
+                return false;
+            }
+        }
+
+        const std::string longer = PostfixConverter::getPostfix("(a|b)*" + tail + "a");
+        options.engine = MatchEngine::BitParallel;
+        const std::unique_ptr<const FiniteAutomaton> fallback(FiniteAutomaton::buildFromRegex(longer, options));
+        return !GlushkovMatcher::build(longer) && fallback->getCompiledDFA() && fallback->process("b" + tail + "a")
+               && !fallback->process(tail);
+    }
+
+    // Bytes whose columns agree in every row share a class, and every byte that leads
+    // nowhere shares the reject class; matching is unchanged.
+    bool alphabetCompressionMergesColumns() {
+        CompiledDFA table(2, 0);
+        for (const unsigned char symbol: {'a', 'b', 'c'}) table.setTransition(0, symbol, 1);
+        table.setTransition(1, 'a', 1);
+        table.setTransition(1, 'b', 1);
+        table.setTransition(1, 'c', 0);
+        table.setAccepting(1);
+        table.compressAlphabet();
+        if (table.getClassCount() != 3 || table.classOf('a') != table.classOf('b')
+            || table.classOf('a') == table.classOf('c') || table.classOf('z') != table.classOf('\0')
+            || !table.process("abba") || table.process("abc") || !table.process("acb") || table.process("az")) {
+            return false;
+        }
+
+        CompileOptions options;
+        options.engine = MatchEngine::DFA;
+        options.minimize = true;
+        const std::unique_ptr<const FiniteAutomaton> fa(
+            FiniteAutomaton::buildFromRegex(PostfixConverter::getPostfix("(a|b|c)*d"), options));
+        const CompiledDFA &dfa = *fa->getCompiledDFA();
+        return dfa.getClassCount() == 3 && dfa.classOf('a') == dfa.classOf('c') && dfa.classOf('a') != dfa.classOf('d')
+               && fa->process("cabd") && !fa->process("cab");
+    }
+
+    // Chunks of any size, a mapped file and processFile all give process()'s answer, for
+    // the table and the bit-parallel streams; finish() starts the next input afresh.
+    bool streamMatcherSplitsAnywhere() {
+        std::string text;
+        std::mt19937 random(8);
+        for (int i = 0; i < 2000; ++i) text += random() % 2 ? "ab" : "c";
+        text += 'd';
+        const std::string path = "regression-stream.txt";
+        std::ofstream(path, std::ios::binary) << text;
+
+        bool same = true;
+        for (const MatchEngine engine: {MatchEngine::DFA, MatchEngine::BitParallel}) {
+            CompileOptions options;
+            options.engine = engine;
+            const std::unique_ptr<const FiniteAutomaton> fa(
+                FiniteAutomaton::buildFromRegex(PostfixConverter::getPostfix("(ab|c)*d"), options));
+            StreamMatcher matcher = fa->streamMatcher();
+            for (size_t chunk = 1; chunk <= 7; ++chunk) {
+                for (size_t begin = 0; begin < text.size(); begin += chunk) {
+                    matcher.feed(std::string_view(text).substr(begin, chunk));
+                }
+                same = same && matcher.finish() && !matcher.finish();
+            }
+            matcher.feed(text);
+            matcher.feed("d");
+            same = same && !matcher.finish();
+            matcher.feed("ab");
+            matcher.reset();
+            matcher.feedFile(path);
+            same = same && matcher.finish() && fa->processFile(path) && fa->process(text);
+        }
+        std::remove(path.c_str());
+        return same;
+    }
+
+    // Engines without a State graph print a header line instead of empty state sections.
+    bool printsEngineSummaryOnly() {
+        const std::unique_ptr<const FiniteAutomaton> glushkov(
+            FiniteAutomaton::buildFromRegex(PostfixConverter::getPostfix("(a|b)*c")));
+        std::ostringstream summary;
+        summary << *glushkov;
+
+        CompileOptions options;
+        options.engine = MatchEngine::DFA;
+        const std::unique_ptr<const FiniteAutomaton> dfa(
+            FiniteAutomaton::buildFromRegex(PostfixConverter::getPostfix("(a|b)*c"), options));
+        std::ostringstream full;
+        full << *dfa;
+
+        return summary.str().starts_with("> Bit-parallel") && summary.str().find("> States") == std::string::npos
+               && full.str().find("> State Map:\n>> q0:") != std::string::npos;
+    }
+
+    // CompileOptions::log traces the Thompson NFA even when Auto picks an engine that
+    // does not otherwise build it (Literal for ab|cd, BitParallel for (a|b)*c).
+    bool logTracesEveryEngine() {
+        for (const char *regex: {"ab|cd", "(a|b)*c"}) {
+            std::ostringstream log;
+            CompileOptions options;
+            options.log = &log;
+            delete FiniteAutomaton::buildFromRegex(PostfixConverter::getPostfix(regex), options);
+            if (log.str().find(" - a > ") == std::string::npos) return false;
+        }
+        return true;
+    }
+
+    // a*b*c|d over a long run of a's: every start leads into the same state, so one pass
+    // finds the single match (starting per position would take about n^2 / 2 steps).
+    bool searchIsSinglePass() {
+        const std::string text = std::string(size_t{1} << 20, 'a') + "cad";
+        for (const MatchEngine engine: {MatchEngine::DFA, MatchEngine::BitParallel}) {
+            CompileOptions options;
+            options.engine = engine;
+            const std::unique_ptr<const FiniteAutomaton> fa(
+                FiniteAutomaton::buildFromRegex(PostfixConverter::getPostfix("a*b*c|d"), options));
+            const std::vector<std::pair<size_t, size_t>> expected = {
+                {0, text.size() - 2}, {text.size() - 1, text.size()}};
+            if (fa->search(text) != expected || !fa->search(text.substr(0, text.size() - 3)).empty()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Leftmost beats earliest-ending (abcd|c), empty matches are skipped (a*), and the
+    // prefix and required-literal skips find the same spans, on every engine.
+    bool searchFindsLeftmostLongest() {
+        using Spans = std::vector<std::pair<size_t, size_t>>;
+        const std::vector<std::tuple<const char *, const char *, Spans>> cases = {
+            {"abcd|c", "abcd xc", {{0, 4}, {6, 7}}},
+            {"a*", "baab", {{1, 3}}},
+            {"(a|ab)(c|bcd)", "abcd", {{0, 4}}},
+            {"foo(a|b)*", "xxfooabxfoo", {{2, 7}, {8, 11}}},
+            {"(a|b)*needle(a|b)*", "abneedleba needl", {{0, 10}}},
+            {"(a|b)*needle(a|b)*", "ab needl ba", {}},
+        };
+        for (const auto &[regex, text, expected]: cases) {
+            for (const MatchEngine engine: {MatchEngine::Auto, MatchEngine::DFA, MatchEngine::LazyDFA,
+                                            MatchEngine::BitParallel}) {
+                CompileOptions options;
+                options.engine = engine;
+                const std::unique_ptr<const FiniteAutomaton> fa(
+                    FiniteAutomaton::buildFromRegex(PostfixConverter::getPostfix(regex), options));
+                if (fa->search(text) != expected) return false;
+            }
+        }
+        return true;
+    }
+
+    // StaticRegex shares RegexSyntax with PostfixConverter, so both give the same postfix.
+    template<StaticRegexDetail::FixedString Pattern>
+    bool samePostfix() {
+        constexpr auto postfix = StaticRegexDetail::toPostfix<Pattern>();
+        return std::string(postfix.items.data(), postfix.size) == PostfixConverter::getPostfix(Pattern.data);
+    }
+
+    static_assert(StaticRegex<"(a|b)(a|b|0|1)*">::match("ab01"));
+    static_assert(!StaticRegex<"(a|b)(a|b|0|1)*">::match("0ab"));
+    static_assert(StaticRegex<"a+b?c*">::match("aac") && !StaticRegex<"a+b?c*">::match("bc"));
+    static_assert(StaticRegex<"(ab)*a">::longestMatch("ababab") == 5);
+
+    bool staticRegexMatchesPostfixConverter() {
+        return samePostfix<"(a|b)(a|b|0|1)*">() && samePostfix<"a+b?c*">() && samePostfix<"(ab|c)*(d|e)f">()
+               && samePostfix<"x(y)(z*)?|w">();
+    }
+
+    // Random regex over {a, b, c}, with a generator of words in its language.
+    struct RandomRegex {
+        std::string text;
+        std::function<void(std::mt19937 &, std::string &)> sample;
+    };
+
+    RandomRegex randomRegex(std::mt19937 &random, const int depth) {
+        const unsigned pick = random() % (depth >= 3 ? 3 : 7);
+        if (pick < 3) {
+            const char symbol = "abc"[pick];
+            return {std::string(1, symbol), [symbol](std::mt19937 &, std::string &out) { out += symbol; }};
+        }
+
+        const RandomRegex lhs = randomRegex(random, depth + 1);
+        if (pick == 6) {
+            const char op = "*+?"[random() % 3];
+            return {"(" + lhs.text + ")" + op, [lhs, op](std::mt19937 &r, std::string &out) {
+                const unsigned repeats = op == '?' ? r() % 2 : (op == '+') + r() % 3;
+                for (unsigned i = 0; i < repeats; ++i) lhs.sample(r, out);
+            }};
+        }
+
+        const RandomRegex rhs = randomRegex(random, depth + 1);
+        if (pick == 5) {
+            return {"(" + lhs.text + "|" + rhs.text + ")", [lhs, rhs](std::mt19937 &r, std::string &out) {
+                (r() % 2 ? lhs : rhs).sample(r, out);
+            }};
+        }
+        return {lhs.text + rhs.text, [lhs, rhs](std::mt19937 &r, std::string &out) {
+            lhs.sample(r, out);
+            rhs.sample(r, out);
+        }};
+    }
+
+    std::string randomText(std::mt19937 &random, const size_t maxLength) {
+        std::string text(random() % (maxLength + 1), ' ');
+        for (char &c: text) c = "abcd"[random() % 4];
+        return text;
+    }
+
+    // Leftmost-longest, non-overlapping, non-empty matches, one whole-string match per substring.
+    std::vector<std::pair<size_t, size_t>> referenceSearch(const std::regex &regex, const std::string &text) {
+        std::vector<std::pair<size_t, size_t>> spans;
+        for (size_t begin = 0; begin < text.size();) {
+            size_t end = text.size();
+            while (end > begin && !std::regex_match(text.begin() + begin, text.begin() + end, regex)) --end;
+            if (end > begin) {
+                spans.emplace_back(begin, end);
+                begin = end;
+            } else {
+                ++begin;
+            }
+        }
+        return spans;
+    }
+
+    // Every engine (and a minimized DFA) against std::regex on random regexes: process,
+    // processMany, StreamMatcher over two chunks, and search.
+    bool enginesAgreeWithStdRegex() {
+        std::mt19937 random(2024);
+        for (int round = 0; round < 200; ++round) {
+            const RandomRegex generated = randomRegex(random, 0);
+            const std::regex reference(generated.text);
+
+            std::vector<std::string> words;
+            for (int i = 0; i < 40; ++i) {
+                std::string word = i % 2 ? randomText(random, 24) : "";
+                if (i % 2 == 0) generated.sample(random, word);
+                words.push_back(word);
+            }
+            const std::vector<std::string_view> views(words.begin(), words.end());
+            std::string text;
+            for (int i = 0; i < 4; ++i) {
+                text += randomText(random, 8);
+                generated.sample(random, text);
+            }
+            const auto spans = referenceSearch(reference, text);
+
+            for (const bool minimize: {false, true}) {
+                for (const MatchEngine engine: {MatchEngine::Auto, MatchEngine::DFA, MatchEngine::LazyDFA,
+                                                MatchEngine::BitParallel, MatchEngine::Literal}) {
+                    if (minimize && engine != MatchEngine::DFA) continue;
+
+                    CompileOptions options;
+                    options.engine = engine;
+                    options.minimize = minimize;
+                    const std::unique_ptr<const FiniteAutomaton> fa(
+                        FiniteAutomaton::buildFromRegex(PostfixConverter::getPostfix(generated.text), options));
+
+                    const std::vector<uint64_t> bits = fa->processMany(views);
+                    for (size_t i = 0; i < words.size(); ++i) {
+                        const bool expected = std::regex_match(words[i], reference);
+                        if (fa->process(words[i]) != expected || ((bits[i / 64] >> (i % 64)) & 1) != expected) {
+                            return false;
+                        }
+                        // LazyDFA keeps no resumable state.
+                        if (engine != MatchEngine::LazyDFA) {
+                            StreamMatcher matcher = fa->streamMatcher();
+                            const size_t split = std::min(i % 5, words[i].size());
+                            matcher.feed(std::string_view(words[i]).substr(0, split));
+                            matcher.feed(std::string_view(words[i]).substr(split));
+                            if (matcher.finish() != expected) return false;
+                        }
+                    }
+                    if (fa->search(text) != spans) return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // Calls action(word) for every word over `alphabet` of at most maxLength symbols.
+    void forEachWord(const std::string &alphabet, const size_t maxLength,
+                     const std::function<void(const std::string &)> &action) {
+        std::vector<std::string> level = {""};
+        for (size_t length = 0; length <= maxLength; ++length) {
+            std::vector<std::string> longer;
+            for (const std::string &word: level) {
+                action(word);
+                if (length == maxLength) continue;
+                for (const char symbol: alphabet) longer.push_back(word + symbol);
+            }
+            level = std::move(longer);
+        }
+    }
+
+    // Hopcroft minimization reaches the textbook minimal DFAs (plus the dead row of every
+    // CompiledDFA), through getMinimizedVersion and CompileOptions::minimize alike.
+    bool minimizationReachesMinimalDFA() {
+        const std::vector<std::pair<const char *, uint32_t>> minimalStates = {
+            {"(a|b)*abb", 4}, {"(a|b)*a(a|b)", 4}, {"((a|b)(a|b))*", 2}, {"(ab|ab)*", 2}};
+        for (const auto &[regex, states]: minimalStates) {
+            CompileOptions options;
+            options.engine = MatchEngine::DFA;
+            const std::unique_ptr<const FiniteAutomaton> dfa(
+                FiniteAutomaton::buildFromRegex(PostfixConverter::getPostfix(regex), options));
+            const std::unique_ptr<const FiniteAutomaton> minimized(dfa->getMinimizedVersion());
+            options.minimize = true;
+            const std::unique_ptr<const FiniteAutomaton> compiledMinimized(
+                FiniteAutomaton::buildFromRegex(PostfixConverter::getPostfix(regex), options));
+
+            if (minimized->getCompiledDFA()->getStateCount() != states + 1
+                || compiledMinimized->getCompiledDFA()->getStateCount() != states + 1) {
+                return false;
+            }
+
+            bool same = true;
+            forEachWord("ab", 8, [&](const std::string &word) {
+                const bool expected = dfa->process(word);
+                same = same && minimized->process(word) == expected && compiledMinimized->process(word) == expected;
+            });
+            if (!same) return false;
+        }
+        return true;
+    }
+
+    // Bitset clusters across word boundaries, and a ClusterIndex that keeps its indices
+    // stable while it grows.
+    bool clusterIndexKeepsIndices() {
+        constexpr int width = 200;
+        StateCluster low(width), high(width);
+        for (const int id: {0, 63, 64}) low.insert(id);
+        for (const int id: {64, 130, 199}) high.insert(id);
+
+        std::vector<int> ids;
+        low.unionize(high).forEach([&](const int id) { ids.push_back(id); });
+        StateCluster same(width);
+        for (const int id: {199, 0, 130, 64, 63}) same.insert(id);
+        if (ids != std::vector<int>{0, 63, 64, 130, 199} || same != low.unionize(high) || same.count() != 5
+            || same.hash() != low.unionize(high).hash() || low.contains(130) || !StateCluster(width).isEmpty()) {
+            return false;
+        }
+
+        ClusterIndex index;
+        std::vector<StateCluster> clusters;
+        for (int i = 0; i < 1000; ++i) {
+            StateCluster cluster(width);
+            cluster.insert(i % width);
+            cluster.insert((i * 7 + i / width) % width);
+            if (index.find(cluster) == -1 && !index.insert(cluster).second) return false;
+            clusters.push_back(cluster);
+        }
+        for (const StateCluster &cluster: clusters) {
+            const int id = index.find(cluster);
+            if (id == -1 || index[id] != cluster || index.insert(cluster) != std::pair(id, false)) return false;
+        }
+        return true;
+    }
+
+    // Edges of every node, in insertion order, packed into CSR rows; a second finalize()
+    // merges new nodes and edges into the packed ones.
+    bool nfaGraphPacksEdges() {
+        auto edgesOf = [](const NFAGraph &graph, const int node) {
+            std::vector<std::pair<int, char>> result;
+            for (const auto &[target, symbol]: graph.connections(node)) result.emplace_back(target, symbol);
+            return result;
+        };
+
+        NFAGraph graph;
+        const int first = graph.addNode(), second = graph.addNode(), third = graph.addNode();
+        graph.connect(second, third, 'b');
+        graph.connect(first, second, 'a');
+        graph.connect(first, third);
+        graph.connect(second, first, 'c');
+        graph.finalize();
+        if (graph.size() != 3 || graph.edgeCount() != 4
+            || edgesOf(graph, first) != std::vector<std::pair<int, char>>{{second, 'a'}, {third, '\0'}}
+            || edgesOf(graph, second) != std::vector<std::pair<int, char>>{{third, 'b'}, {first, 'c'}}
+            || !edgesOf(graph, third).empty()) {
+            return false;
+        }
+
+        const int fourth = graph.addNode();
+        graph.connect(third, fourth, 'd');
+        graph.connect(first, fourth, 'e');
+        graph.finalize();
+        return graph.edgeCount() == 6
+               && edgesOf(graph, first) == std::vector<std::pair<int, char>>{{second, 'a'}, {third, '\0'}, {fourth, 'e'}}
+               && edgesOf(graph, third) == std::vector<std::pair<int, char>>{{fourth, 'd'}}
+               && edgesOf(graph, fourth).empty();
+    }
+
+    // One pass over a word reports exactly the patterns that accept it alone, also after
+    // a pattern is added and the set recompiled.
+    bool regexSetMatchesEachPattern() {
+        std::vector<std::string> regexes = {"(a|b)*", "ab", "a(a|b)*", "c", "(ab)*c?"};
+        RegexSet set;
+        for (const std::string &regex: regexes) set.add(PostfixConverter::getPostfix(regex));
+        set.compile();
+        if (set.matches("ab") != std::vector<int>{0, 1, 2, 4} || set.matches("") != std::vector<int>{0, 4}
+            || !set.matches("d").empty()) {
+            return false;
+        }
+
+        regexes.emplace_back("b+");
+        set.add(PostfixConverter::getPostfix(regexes.back()));
+        set.compile();
+        std::vector<std::unique_ptr<const FiniteAutomaton>> singles;
+        for (const std::string &regex: regexes) {
+            singles.emplace_back(FiniteAutomaton::buildFromRegex(PostfixConverter::getPostfix(regex)));
+        }
+
+        bool same = set.size() == regexes.size();
+        forEachWord("abc", 6, [&](const std::string &word) {
+            std::vector<int> expected;
+            for (size_t i = 0; i < singles.size(); ++i) {
+                if (singles[i]->process(word)) expected.push_back(static_cast<int>(i));
+            }
+            same = same && set.matches(word) == expected;
+        });
+        return same;
+    }
+
+    // Closures from the SCC condensation equal a plain search along lambda edges, on
+    // random graphs full of lambda cycles (and self-loops).
+    bool lambdaScopeMatchesSearch() {
+        std::mt19937 random(17);
+        for (int round = 0; round < 20; ++round) {
+            NFAGraph graph;
+            const int nodes = 100 + static_cast<int>(random() % 100);
+            for (int i = 0; i < nodes; ++i) graph.addNode();
+            for (int i = 0; i < 2 * nodes; ++i) {
+                graph.connect(static_cast<int>(random() % nodes), static_cast<int>(random() % nodes),
+                              random() % 5 < 2 ? 'a' : '\0');
+            }
+            graph.finalize();
+
+            const std::vector<StateCluster> closures = FiniteAutomaton::LambdaScope(graph);
+            for (int origin = 0; origin < nodes; ++origin) {
+                StateCluster expected(nodes);
+                std::vector<int> stack = {origin};
+                expected.insert(origin);
+                while (!stack.empty()) {
+                    const int node = stack.back();
+                    stack.pop_back();
+                    for (const auto &[target, symbol]: graph.connections(node)) {
+                        if (symbol == '\0' && !expected.contains(target)) {
+                            expected.insert(target);
+                            stack.push_back(target);
+                        }
+                    }
+                }
+                if (closures[origin] != expected) return false;
+            }
+        }
+        return true;
+    }
+
+    // Frontiers expanded on a pool give the serial subset construction, numbering included.
+    // (a|b)*a(a|b)^7 has more than 256 DFA states and frontiers wide enough to be split.
+    bool parallelSubsetConstructionIsDeterministic() {
+        const std::string postfix = PostfixConverter::getPostfix("(a|b)*a(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)");
+        NFAGraph graph;
+        const RegToken token = RegToken::getENFAToken(postfix, graph);
+        const std::vector<char> sigma = {'a', 'b'};
+
+        const DeterminizedNFA serial = FiniteAutomaton::determinize(graph, token.startNode, sigma, 1);
+        for (const unsigned threads: {2u, 4u}) {
+            const DeterminizedNFA parallel = FiniteAutomaton::determinize(graph, token.startNode, sigma, threads);
+            if (parallel.transitions != serial.transitions || parallel.clusters.size() != serial.clusters.size()
+                || parallel.sigma != serial.sigma) {
+                return false;
+            }
+            for (int state = 0; state < serial.clusters.size(); ++state) {
+                if (parallel.clusters[state] != serial.clusters[state]) return false;
+            }
+        }
+        return serial.clusters.size() > 256;
+    }
+
+    // Postfix forms of one language share a cache key, options that change the automaton
+    // do not, and the least recently used entry is the one evicted.
+    bool compileCacheNormalizesKeys() {
+        auto normalized = [](const char *regex) {
+            return CompileCache::normalize(PostfixConverter::getPostfix(regex));
+        };
+        if (normalized("a(bc)") != normalized("(ab)c") || normalized("a|(b|c)") != normalized("(a|b)|c")
+            || normalized("a**") != "a*" || normalized("(a?)+") != "a*" || normalized("(a+)*") != "a*"
+            || CompileCache::normalize("a|") != "a|") {
+            return false;
+        }
+
+        CompileCache cache(2, size_t{64} << 20, 1);
+        const CompileCache::Handle first = cache.get(PostfixConverter::getPostfix("a(bc)"));
+        if (cache.get(PostfixConverter::getPostfix("(ab)c")) != first || cache.getHits() != 1) return false;
+
+        CompileOptions options;
+        options.engine = MatchEngine::DFA;
+        if (cache.get(PostfixConverter::getPostfix("(ab)c"), options) == first || cache.getMisses() != 2) return false;
+
+        cache.get(PostfixConverter::getPostfix("x*"));
+        const bool evicted = cache.size() == 2 && cache.get(PostfixConverter::getPostfix("abc")) != first;
+        return evicted && first->process("abc") && cache.getMisses() == 4;
+    }
+
+    // Compile figures belong to the engine that was built, serialize to valid JSON, and
+    // match counters stop counting transitions where the automaton dies.
+    bool statsDescribeTheRun() {
+        CompileStats dfaStats, autoStats;
+        CompileOptions options;
+        options.engine = MatchEngine::DFA;
+        options.stats = &dfaStats;
+        const std::unique_ptr<const FiniteAutomaton> dfa(
+            FiniteAutomaton::buildFromRegex(PostfixConverter::getPostfix("(a|b)*abb"), options));
+        options.engine = MatchEngine::Auto;
+        options.stats = &autoStats;
+        delete FiniteAutomaton::buildFromRegex(PostfixConverter::getPostfix("(a|b)*abb"), options);
+
+        const nlohmann::json parsed = nlohmann::json::parse(dfaStats.toJson());
+        if (parsed["engine"] != "DFA" || dfaStats.dfaStates + 1 != dfa->getCompiledDFA()->getStateCount()
+            || dfaStats.nfaNodes == 0 || dfaStats.tableBytes == 0 || dfaStats.peakBytes < dfaStats.tableBytes
+            || autoStats.engine != "BitParallel" || autoStats.dfaStates != 0 || autoStats.subsetMs != 0) {
+            return false;
+        }
+
+        MatchStats matchStats;
+        for (const std::string word: {"aabb", "abba", "cabb"}) dfa->process(word, matchStats);
+        return matchStats.calls == 3 && matchStats.accepted == 1 && matchStats.bytesProcessed == 12
+               && matchStats.transitions == 9 && nlohmann::json::parse(matchStats.toJson())["calls"] == 3;
+    }
+
+    // The JSON export of a DFA is the same machine: walking its transitions accepts exactly
+    // the words process() does. The NFA export keeps its epsilon edges, DOT is a digraph, and
+    // engines without explicit states refuse to export.
+    bool exportDescribesTheAutomaton() {
+        CompileOptions options;
+        options.engine = MatchEngine::DFA;
+        const std::string postfix = PostfixConverter::getPostfix("(a|b)*abb");
+        const std::unique_ptr<const FiniteAutomaton> dfa(FiniteAutomaton::buildFromRegex(postfix, options));
+
+        std::ostringstream json, dot, nfa;
+        dfa->exportTo(json, ExportFormat::Json);
+        dfa->exportTo(dot, ExportFormat::Dot);
+        FiniteAutomaton::exportNFA(postfix, nfa, ExportFormat::Json);
+
+        const nlohmann::json parsed = nlohmann::json::parse(json.str());
+        if (parsed["kind"] != "DFA" || parsed["states"].size() + 1 != dfa->getCompiledDFA()->getStateCount()
+            || dot.str().rfind("digraph", 0) != 0) {
+            return false;
+        }
+        bool acceptsAll = true;
+        forEachWord("ab", 6, [&](const std::string &word) {
+            int state = parsed["start"];
+            for (const char c: word) {
+                int next = -1;
+                for (const auto &transition: parsed["transitions"]) {
+                    if (transition["from"] == state && transition["symbol"] == std::string(1, c)) next = transition["to"];
+                }
+                if ((state = next) < 0) break;
+            }
+            const bool accepted = state >= 0 && parsed["states"][state]["accepting"] == true;
+            acceptsAll = acceptsAll && accepted == dfa->process(word);
+        });
+
+        const nlohmann::json parsedNFA = nlohmann::json::parse(nfa.str());
+        bool hasEpsilon = false;
+        for (const auto &transition: parsedNFA["transitions"]) hasEpsilon = hasEpsilon || transition["symbol"].is_null();
+
+        options.engine = MatchEngine::LazyDFA;
+        const std::unique_ptr<const FiniteAutomaton> lazy(FiniteAutomaton::buildFromRegex(postfix, options));
+        try {
+            std::ostringstream ignored;
+            lazy->exportTo(ignored, ExportFormat::Json);
+            return false;
+        } catch (const std::runtime_error &) {
+        }
+        return acceptsAll && hasEpsilon && parsedNFA["kind"] == "NFA";
+    }
+
+    // The direct-coded functions REGExLFACodegen generated for this target (see CMakeLists.txt),
+    // with both dispatch styles, accept what the DFA they were generated from accepts.
+    bool generatedMatchersAgreeWithDFA() {
+        const std::vector<std::tuple<std::string, bool (*)(std::string_view), bool (*)(std::string_view)>> patterns = {
+            {"(a|b)*abb", generated::abb, generatedSwitch::abb},
+            {"(a|b)(a|b|0|1)*", generated::identifier, generatedSwitch::identifier},
+            {"(ab)*c?", generated::optional, generatedSwitch::optional},
+        };
+        CompileOptions options;
+        options.engine = MatchEngine::DFA;
+        for (const auto &[regex, computedGoto, switchDispatch]: patterns) {
+            const std::unique_ptr<const FiniteAutomaton> dfa(
+                FiniteAutomaton::buildFromRegex(PostfixConverter::getPostfix(regex), options));
+            bool agrees = true;
+            forEachWord("abc01\xff", 5, [&](const std::string &word) {
+                const bool expected = dfa->process(word);
+                agrees = agrees && computedGoto(word) == expected && switchDispatch(word) == expected;
+            });
+            if (!agrees) return false;
+        }
+        return true;
+    }
+
+    // processMany gives process()'s answer for every word and engine, on one thread and
+    // split over a pool. (a|b)*a(a|b){11} has a table past cacheResidentBytes, so the DFA
+    // walks its long words in lanes; interleavedMatch is also forced into lanes directly.
+    bool processManyMatchesProcess() {
+        std::string wide = "(a|b)*a";
+        for (int i = 0; i < 11; ++i) wide += "(a|b)";
+        std::mt19937 random(21);
+        std::vector<std::string> words;
+        for (size_t i = 0; i < 3 * FiniteAutomaton::batchChunkWords; ++i) {
+            std::string word;
+            for (size_t length = random() % 40; length > 0; --length) word += "aabbc"[random() % 5];
+            words.push_back(word);
+        }
+        const std::vector<std::string_view> views(words.begin(), words.end());
+
+        for (const std::string &regex: {std::string("(a|b)*abb"), wide, std::string("abba|baab|ab")}) {
+            for (const MatchEngine engine: {MatchEngine::Auto, MatchEngine::DFA, MatchEngine::LazyDFA,
+                                            MatchEngine::BitParallel}) {
+                CompileOptions options;
+                options.engine = engine;
+                const std::unique_ptr<const FiniteAutomaton> fa(
+                    FiniteAutomaton::buildFromRegex(PostfixConverter::getPostfix(regex), options));
+                std::vector<uint64_t> expected((words.size() + 63) / 64);
+                for (size_t i = 0; i < words.size(); ++i) {
+                    if (fa->process(words[i])) expected[i / 64] |= uint64_t{1} << (i % 64);
+                }
+                if (fa->processMany(views) != expected || fa->processMany(views, 2) != expected) return false;
+
+                if (engine != MatchEngine::DFA) continue;
+                const CompiledDFA &dfa = *fa->getCompiledDFA();
+                for (const size_t minLaneLength: {size_t{0}, SIZE_MAX}) {
+                    std::vector<uint64_t> bits(expected.size());
+                    interleavedMatch(std::span<const std::string_view>(views), bits.data(), dfa.getStartState(),
+                                     dfa.getDeadState(),
+                                     [&](const uint32_t state, const unsigned char c) { return dfa.next(state, c); },
+                                     [&](const uint32_t state) { return dfa.isAccepting(state); }, minLaneLength);
+                    if (bits != expected) return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // A definition with comments, padded tokens and long lines (read eight bytes at a time),
+    // whose transitions name states before the States section declares them; then one with
+    // enough states to grow the name table several times. Ids follow declaration order.
+    bool setupParsesDefinitions() {
+        const Setup small = Setup::fromText("# an automaton for (a|b)*abb\n"
+                                            "Sigma\n"
+                                            "a\n"
+                                            "b\n"
+                                            "Transitions\n"
+                                            "# every state moves on both symbols\n"
+                                            "firstState ,a,   secondState\n"
+                                            "firstState,b,firstState\n"
+                                            "secondState, a, secondState\n"
+                                            "secondState, b,thirdState\n"
+                                            "thirdState,a,secondState\n"
+                                            "thirdState,b,acceptingState\n"
+                                            "acceptingState,a,secondState\n"
+                                            "acceptingState,b,firstState\n"
+                                            "End\n"
+                                            "States\n"
+                                            "secondState\n"
+                                            "  firstState , S\n"
+                                            "thirdState\n"
+                                            "acceptingState,F\n"
+                                            "End");
+        const std::vector<std::string> expectedStates = {"secondState", "firstState", "thirdState", "acceptingState"};
+        if (small.getSigma() != std::vector<char>{'a', 'b'} || small.getStates() != expectedStates
+            || small.getInitialState() != 1 || small.getFinalStates() != std::vector<bool>{false, false, false, true}
+            || small.getTransitions().size() != 8) {
+            return false;
+        }
+        const std::vector<std::tuple<uint32_t, char, uint32_t>> expectedTransitions = {
+            {1, 'a', 0}, {1, 'b', 1}, {0, 'a', 0}, {0, 'b', 2}, {2, 'a', 0}, {2, 'b', 3}, {3, 'a', 0}, {3, 'b', 1}};
+        for (size_t i = 0; i < expectedTransitions.size(); ++i) {
+            const auto &[from, to, symbol] = small.getTransitions()[i];
+            if (std::tuple(from, symbol, to) != expectedTransitions[i]) return false;
+        }
+
+        constexpr uint32_t count = 5000;
+        std::string text = "Sigma\na\nTransitions\n";
+        for (uint32_t i = 0; i < count; ++i) {
+            text += "q" + std::to_string(i) + ",a,q" + std::to_string((i * 7 + 3) % count) + "\n";
+        }
+        text += "States\n";
+        for (uint32_t i = count; i-- > 0;) {
+            text += "q" + std::to_string(i) + (i == 0 ? ",S" : "") + (i % 2 ? ",F" : "") + "\n";
+        }
+        const Setup large = Setup::fromText(text + "End\n");
+        if (large.getStates().size() != count || large.getInitialState() != count - 1) return false;
+        for (uint32_t i = 0; i < count; ++i) {
+            const auto &[from, to, symbol] = large.getTransitions()[i];
+            if (large.getStates()[from] != "q" + std::to_string(i)
+                || large.getStates()[to] != "q" + std::to_string((i * 7 + 3) % count) || symbol != 'a'
+                || large.getFinalStates()[from] != (i % 2 == 1)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Definition of the NFA for (a|b)*a(a|b){n}: q0 guesses which 'a' is n symbols from
+    // the end. Its minimal DFA has 2^(n+1) states.
+    std::string guessingDefinition(const int n) {
+        std::string text = "Sigma\na\nb\nStates\nq0,S\n";
+        for (int i = 1; i <= n + 1; ++i) text += "q" + std::to_string(i) + (i == n + 1 ? ",F\n" : "\n");
+        text += "Transitions\nq0,a,q0\nq0,b,q0\nq0,a,q1\n";
+        for (int i = 1; i <= n; ++i) {
+            for (const char symbol: {'a', 'b'}) {
+                text += "q" + std::to_string(i) + "," + symbol + ",q" + std::to_string(i + 1) + "\n";
+            }
+        }
+        return text + "End\n";
+    }
+
+    // The bitset simulation and the table it determinizes into accept the same words and
+    // find the same longest prefixes, one word at a time and in a batch. A definition
+    // past subsetConstructionStates is loaded as a simulated NFA and still matches.
+    bool nfaSimulatorMatchesItsDFA() {
+        const NFASimulator small(Setup::fromText(guessingDefinition(3)));
+        const std::shared_ptr<CompiledDFA> table = small.determinize(64);
+        if (!table || table->getStateCount() != 17 || small.determinize(8) != nullptr) return false;
+
+        std::mt19937 random(23);
+        std::vector<std::string> words;
+        for (int i = 0; i < 500; ++i) {
+            std::string word;
+            for (size_t length = random() % 12; length > 0; --length) word += "abbc"[random() % 4];
+            words.push_back(word);
+        }
+        const std::vector<std::string_view> views(words.begin(), words.end());
+        std::vector<uint64_t> simulated((words.size() + 63) / 64), determinized(simulated.size());
+        small.processMany(views, simulated.data());
+        table->processMany(views, determinized.data());
+        if (simulated != determinized) return false;
+        for (const std::string &word: words) {
+            if (small.process(word) != table->process(word) || small.longestMatch(word) != table->longestMatch(word)) {
+                return false;
+            }
+        }
+
+        const int n = static_cast<int>(FiniteAutomaton::subsetConstructionStates);
+        const auto path = std::filesystem::temp_directory_path() / "regexlfa-regression-nfa.txt";
+        std::ofstream(path) << guessingDefinition(n);
+        const std::unique_ptr<const FiniteAutomaton> large(FiniteAutomaton::loadDefinition(path.string()));
+        std::filesystem::remove(path);
+        if (large->getCompiledDFA() != nullptr) return false;
+        for (int i = 0; i < 50; ++i) {
+            std::string word;
+            for (size_t length = n + random() % 8; length > 0; --length) word += "ab"[random() % 2];
+            if (large->process(word) != (word[word.size() - n - 1] == 'a')) return false;
+        }
+        return true;
+    }
+
+    // Random literal sets, overlapping and prefixing each other (and single literals), give
+    // the Literal engine the DFA engine's answers for process, processMany, StreamMatcher
+    // and search; LiteralMatcher's longestMatch agrees with the DFA table's.
+    bool literalEngineMatchesDFA() {
+        std::mt19937 random(25);
+        for (int round = 0; round < 40; ++round) {
+            std::vector<std::string> literals;
+            std::string regex;
+            for (size_t count = 1 + random() % (round % 4 == 0 ? 1 : 6); count > 0; --count) {
+                std::string literal;
+                for (size_t length = 1 + random() % 4; length > 0; --length) literal += "ab"[random() % 2];
+                regex += (regex.empty() ? "" : "|") + literal;
+                literals.push_back(literal);
+            }
+            const std::string postfix = PostfixConverter::getPostfix(regex);
+            CompileOptions options;
+            options.engine = MatchEngine::Literal;
+            const std::unique_ptr<const FiniteAutomaton> literal(FiniteAutomaton::buildFromRegex(postfix, options));
+            options.engine = MatchEngine::DFA;
+            const std::unique_ptr<const FiniteAutomaton> dfa(FiniteAutomaton::buildFromRegex(postfix, options));
+            const std::shared_ptr<LiteralMatcher> matcher = LiteralMatcher::build(literals);
+
+            std::ostringstream summary;
+            summary << *literal;
+            if (summary.str().rfind("> Literal matcher", 0) != 0) return false;
+
+            std::vector<std::string> words;
+            forEachWord("abc", 5, [&](const std::string &word) { words.push_back(word); });
+            const std::vector<std::string_view> views(words.begin(), words.end());
+            if (literal->processMany(views) != dfa->processMany(views)) return false;
+            for (const std::string &word: words) {
+                StreamMatcher stream = literal->streamMatcher();
+                stream.feed(std::string_view(word).substr(0, word.size() / 2));
+                stream.feed(std::string_view(word).substr(word.size() / 2));
+                const bool expected = dfa->process(word);
+                if (literal->process(word) != expected || stream.finish() != expected) return false;
+            }
+
+            const std::string text = randomText(random, 300);
+            if (literal->search(text) != dfa->search(text)) return false;
+            for (size_t begin = 0; begin < text.size(); ++begin) {
+                const std::string_view suffix = std::string_view(text).substr(begin);
+                if (matcher->longestMatch(suffix) != dfa->getCompiledDFA()->longestMatch(suffix)) return false;
+            }
+        }
+        return true;
+    }
+
+    // Everything Tester prints to std::cout during action().
+    std::string captureOutput(const std::function<void()> &action) {
+        std::ostringstream captured;
+        std::streambuf *previous = std::cout.rdbuf(captured.rdbuf());
+        action();
+        std::cout.rdbuf(previous);
+        return captured.str();
+    }
+
+    // Three files of more than streamWindow entries, named against their order, so only
+    // (file, entry) ordering makes stream() and run() print the same thing.
+    bool streamMatchesRun() {
+        const auto directory = std::filesystem::temp_directory_path() / "regexlfa-regression-tests";
+        std::filesystem::create_directories(directory);
+        size_t remaining = 3 * 300;
+        for (const char *file: {"a.json", "b.json", "c.json"}) {
+            std::ofstream out(directory / file);
+            out << "[";
+            for (int entry = 0; entry < 300; ++entry) {
+                out << (entry ? "," : "") << R"({"name": "t)" << --remaining << R"(", "regex": "(a|b)*a)"
+                    << entry % 7 << R"(", "test_strings": [{"input": "ba)" << entry % 7 << R"(", "expected": true}]})";
+            }
+            out << "]";
+        }
+
+        Tester &tester = Tester::getInstance();
+        const std::string previousDirectory = tester.getTestDirectory();
+        tester.setTestDirectory(directory.string());
+        const std::string ran = captureOutput([&] {
+            tester.init();
+            tester.run();
+        });
+        const std::string streamed = captureOutput([&] { tester.stream(); });
+        const std::string streamedAgain = captureOutput([&] { tester.stream(); });
+        tester.setTestDirectory(previousDirectory);
+        std::filesystem::remove_all(directory);
+
+        return !ran.empty() && ran == streamed && streamed == streamedAgain
+               && ran.find("Test name: t899\n") < ran.find("Test name: t0\n");
+    }
+
+    // A saved DFA loads as a mapped table that answers like the original. A bad magic is
+    // rejected, and engines without a table refuse to save.
+    bool saveLoadRoundTrips() {
+        CompileOptions options;
+        options.engine = MatchEngine::DFA;
+        const std::unique_ptr<const FiniteAutomaton> fa(
+            FiniteAutomaton::buildFromRegex(PostfixConverter::getPostfix("(a|b)*a(b|c)+|c"), options));
+        const std::string path = "regression-round-trip.bin";
+        fa->save(path);
+        const std::unique_ptr<const FiniteAutomaton> loaded(FiniteAutomaton::load(path));
+
+        bool same = loaded->getCompiledDFA()->isMapped();
+        std::vector<std::string> words;
+        forEachWord("abc", 6, [&](const std::string &word) {
+            words.push_back(word);
+            same = same && loaded->process(word) == fa->process(word);
+        });
+        const std::vector<std::string_view> views(words.begin(), words.end());
+        same = same && loaded->processMany(views) == fa->processMany(views)
+               && loaded->search("cabbacab") == fa->search("cabbacab");
+
+        {
+            std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+            file.put('X');
+        }
+        bool rejected = false;
+        try {
+            delete FiniteAutomaton::load(path);
+        } catch (const std::runtime_error &) {
+            rejected = true;
+        }
+        std::remove(path.c_str());
+
+        options.engine = MatchEngine::LazyDFA;
+        const std::unique_ptr<const FiniteAutomaton> lazy(
+            FiniteAutomaton::buildFromRegex(PostfixConverter::getPostfix("(a|b)*"), options));
+        bool refused = false;
+        try {
+            lazy->save(path);
+        } catch (const std::runtime_error &) {
+            refused = true;
+        }
+        return same && rejected && refused;
+    }
+
+    // A saved automaton cut short at any of a few points is rejected, not mapped.
+    bool loadRejectsTruncatedFiles() {
+        CompileOptions options;
+        options.engine = MatchEngine::DFA;
+        const std::unique_ptr<const FiniteAutomaton> fa(
+            FiniteAutomaton::buildFromRegex(PostfixConverter::getPostfix("(a|b)*abb"), options));
+        const std::string path = "regression-truncated.bin";
+        fa->save(path);
+        const auto size = std::filesystem::file_size(path);
+
+        bool rejected = true;
+        for (const auto length: {size - 1, size / 2, uintmax_t{100}, uintmax_t{10}}) {
+            std::filesystem::resize_file(path, length);
+            try {
+                delete FiniteAutomaton::load(path);
+                rejected = false;
+            } catch (const std::runtime_error &) {
+            }
+        }
+        std::remove(path.c_str());
+        return rejected;
+    }
+
+    struct RegressionCase {
+        const char *name;
+        std::function<bool()> run;
+    };
+}
+
+int main() {
+    const std::vector<RegressionCase> cases = {
+        {"Every engine agrees with std::regex", enginesAgreeWithStdRegex},
+        {"Minimization reaches the minimal DFA", minimizationReachesMinimalDFA},
+        {"ClusterIndex keeps indices while growing", clusterIndexKeepsIndices},
+        {"NFAGraph packs and merges edges", nfaGraphPacksEdges},
+        {"CompiledDFA::load rejects wrapped offsets", rejectsWrappedOffsets},
+        {"FiniteAutomaton::load rejects truncated files", loadRejectsTruncatedFiles},
+        {"FiniteAutomaton::save and load round-trip", saveLoadRoundTrips},
+        {"ThreadPool workers submit to another pool", nestedPoolsSubmit},
+        {"ThreadPool::wait rethrows a task's exception", poolRethrowsTaskFailure},
+        {"ThreadPool::wait covers tasks submitted by tasks", poolWaitsForFanOut},
+        {"LazyDFA fallback rejects NUL bytes", lazyFallbackRejectsNul},
+        {"LazyDFA flushes a stale cache and recovers", lazyCacheRecoversAfterFlush},
+        {"LazyDFA matches the full DFA with a small cache", lazyMatchesFullDFAUnderPressure},
+        {"Glushkov matcher handles 63 positions", glushkovHandlesMaxPositions},
+        {"Alphabet compression merges equal columns", alphabetCompressionMergesColumns},
+        {"StreamMatcher splits input anywhere", streamMatcherSplitsAnywhere},
+        {"operator<< skips empty state sections", printsEngineSummaryOnly},
+        {"CompileOptions::log traces every engine", logTracesEveryEngine},
+        {"Tester::stream prints in the order of run", streamMatchesRun},
+        {"FiniteAutomaton::search is a single pass", searchIsSinglePass},
+        {"FiniteAutomaton::search finds leftmost-longest spans", searchFindsLeftmostLongest},
+        {"RegexSet reports every accepting pattern", regexSetMatchesEachPattern},
+        {"LambdaScope closures match a plain search", lambdaScopeMatchesSearch},
+        {"Parallel subset construction matches the serial one", parallelSubsetConstructionIsDeterministic},
+        {"CompileCache shares keys of equivalent postfix", compileCacheNormalizesKeys},
+        {"Compile and match stats describe the run", statsDescribeTheRun},
+        {"exportTo and exportNFA describe the automaton", exportDescribesTheAutomaton},
+        {"Generated matchers agree with the DFA", generatedMatchersAgreeWithDFA},
+        {"processMany matches process on every engine", processManyMatchesProcess},
+        {"Setup parses padded, commented definitions", setupParsesDefinitions},
+        {"NFASimulator matches its determinized table", nfaSimulatorMatchesItsDFA},
+        {"Literal engine matches the DFA engine", literalEngineMatchesDFA},
+        {"StaticRegex converts like PostfixConverter", staticRegexMatchesPostfixConverter},
+    };
+
+    int failed = 0;
+    for (const auto &[name, run]: cases) {
+        const bool passed = run();
+        std::cout << (passed ? "pass: " : "FAIL: ") << name << std::endl;
+        failed += !passed;
+    }
+    return failed == 0 ? 0 : 1;
+}